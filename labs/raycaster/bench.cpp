@@ -0,0 +1,394 @@
+#include "controller.h"
+#include "cpufeatures.h"
+#include "geometry.h"
+#include "lightbuffer.h"
+#include "lightcache.h"
+#include "lightscheduler.h"
+#include "polygon.h"
+#include "softshadow.h"
+#include "tools/util/util.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <numbers>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t SCENE_SEED = 20'240'917U;
+constexpr int MAX_RADIUS = 12;
+
+// N star-shaped polygons of M vertices each: vertex angles are sorted random values, so every
+// polygon is simple, and the radius jitter makes a good share of them concave.
+RaycasterController makeScene(int polygonCount, int vertexCount) {
+    RandomGenerator rng(SCENE_SEED);
+    RaycasterController controller;
+    for (int p = 0; p < polygonCount; ++p) {
+        int cx = rng.GenInt(MAX_RADIUS, GlobalConfig::SCENE_WIDTH - MAX_RADIUS);
+        int cy = rng.GenInt(MAX_RADIUS, GlobalConfig::SCENE_HEIGHT - MAX_RADIUS);
+        auto angles = rng.GenRealVector(vertexCount, 0.0, 2.0 * std::numbers::pi);
+        auto radii = rng.GenRealVector(vertexCount, MAX_RADIUS / 3.0, MAX_RADIUS);
+        std::ranges::sort(angles);
+        std::vector<GeometryNS::Point> vertices;
+        for (int v = 0; v < vertexCount; ++v) {
+            vertices.push_back(
+                {cx + static_cast<int>(radii[v] * std::cos(angles[v])),
+                 cy + static_cast<int>(radii[v] * std::sin(angles[v]))});
+        }
+        controller.beginPolygon(vertices.front());
+        for (size_t v = 1; v < vertices.size(); ++v) {
+            controller.appendVertex(vertices[v]);
+        }
+        controller.completePolygon();
+    }
+    controller.setLightPosition(
+        {GlobalConfig::SCENE_WIDTH / 2 + 1, GlobalConfig::SCENE_HEIGHT / 2 + 1});
+    return controller;
+}
+
+void sceneSizes(benchmark::internal::Benchmark* bench) {
+    bench->ArgNames({"polygons", "vertices"});
+    for (int polygons : {10, 100, 1000}) {
+        for (int vertices : {4, 16}) {
+            bench->Args({polygons, vertices});
+        }
+    }
+    bench->Unit(benchmark::kMicrosecond);
+}
+
+void BM_GenerateLightRays(benchmark::State& state) {
+    auto controller = makeScene(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    size_t rays = 0;
+    for (auto _ : state) {
+        auto generated = controller.generateLightRays();
+        rays = generated.size();
+        benchmark::DoNotOptimize(generated.data());
+    }
+    state.counters["rays"] = static_cast<double>(rays);
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(rays));
+}
+
+// Sorting alone on a shuffled fan, with the working buffers kept between iterations.
+void BM_SortRaySegments(benchmark::State& state) {
+    auto controller = makeScene(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    auto shuffled = controller.generateLightRays();
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(SCENE_SEED));
+    std::vector<RaySegmentNS::RaySegment> rays;
+    std::vector<RaySegmentNS::RaySegment> sorted;
+    std::vector<RaySortKey> keys;
+    std::vector<RaySortKey> spare;
+    for (auto _ : state) {
+        state.PauseTiming();
+        rays = shuffled;
+        state.ResumeTiming();
+        sortRaySegmentsByDirection(&rays, &keys, &spare, &sorted);
+        benchmark::DoNotOptimize(rays.data());
+    }
+    state.counters["rays"] = static_cast<double>(shuffled.size());
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(shuffled.size()));
+}
+
+// Tracing only overwrites the end points, so the same ray array is reused between iterations.
+void BM_ProcessRayIntersections(benchmark::State& state) {
+    auto controller = makeScene(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    auto rays = controller.generateLightRays();
+    for (auto _ : state) {
+        controller.processRayIntersections(&rays);
+        benchmark::ClobberMemory();
+    }
+    state.counters["rays"] = static_cast<double>(rays.size());
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(rays.size()));
+}
+
+void BM_FilterDuplicateRays(benchmark::State& state) {
+    auto controller = makeScene(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    auto traced = controller.generateLightRays();
+    controller.processRayIntersections(&traced);
+    std::vector<RaySegmentNS::RaySegment> rays;
+    for (auto _ : state) {
+        state.PauseTiming();
+        rays = traced;
+        state.ResumeTiming();
+        controller.filterDuplicateRays(&rays);
+        benchmark::DoNotOptimize(rays.data());
+    }
+    state.counters["rays"] = static_cast<double>(traced.size());
+    state.counters["kept"] = static_cast<double>(rays.size());
+}
+
+template <VisibilityEngine Engine>
+void BM_ComputeLightArea(benchmark::State& state) {
+    auto controller = makeScene(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    controller.setVisibilityEngine(Engine);
+    size_t vertices = 0;
+    for (auto _ : state) {
+        auto area = controller.computeLightArea();
+        vertices = area.size();
+        benchmark::DoNotOptimize(area.data());
+    }
+    state.counters["area_vertices"] = static_cast<double>(vertices);
+}
+
+// Hovering in a small region: the light random-walks inside a 32 px square and every frame goes
+// through a LightAreaCache first, as in LightWorker.
+void BM_HoverWithCache(benchmark::State& state) {
+    constexpr int HOVER_SIZE = 32;
+    auto controller = makeScene(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    controller.setVisibilityEngine(VisibilityEngine::RayCasting);
+    std::mt19937 rng(SCENE_SEED);
+    std::uniform_int_distribution<int> stepDist(-2, 2);
+    GeometryNS::Point origin{GlobalConfig::SCENE_WIDTH / 3, GlobalConfig::SCENE_HEIGHT / 3};
+    GeometryNS::Point offset{0, 0};
+    LightCacheNS::LightAreaCache cache(GlobalConfig::LIGHT_CACHE_BUDGET_BYTES);
+    LightScratch scratch;
+    std::vector<GeometryNS::Point> area;
+    for (auto _ : state) {
+        offset = {
+            std::clamp(offset.x + stepDist(rng), 0, HOVER_SIZE - 1),
+            std::clamp(offset.y + stepDist(rng), 0, HOVER_SIZE - 1)};
+        LightCacheNS::CacheKey key{origin + offset, controller.getSceneGeneration()};
+        if (!cache.lookup(key, &area)) {
+            controller.computeLightArea(key.lightPos, &scratch, &area);
+            cache.insert(key, area);
+        }
+        benchmark::DoNotOptimize(area.data());
+    }
+    auto stats = cache.getStats();
+    state.counters["hit_rate"] =
+        static_cast<double>(stats.hits) / static_cast<double>(stats.hits + stats.misses);
+    state.counters["cache_kb"] = static_cast<double>(stats.bytes) / 1024.0;
+}
+
+// Soft shadows of two area lights walking across the scene. The budget is lifted, so every
+// frame uses the maximum sample count and the time is the full cost of it.
+void BM_SoftShadows(benchmark::State& state) {
+    auto scene = std::make_shared<const RaycasterController>(
+        makeScene(static_cast<int>(state.range(0)), static_cast<int>(state.range(1))));
+    SoftShadowNS::SoftShadowRenderer renderer;
+    renderer.budget().setBudget(std::numeric_limits<double>::infinity());
+    SoftShadowNS::IntensityBuffer buffer;
+    std::vector<SoftShadowNS::AreaLight> lights(2);
+    int step = 0;
+    for (auto _ : state) {
+        lights[0] = {{GlobalConfig::SCENE_WIDTH / 4 + step, GlobalConfig::SCENE_HEIGHT / 3},
+                     GlobalConfig::AREA_LIGHT_RADIUS};
+        lights[1] = {{GlobalConfig::SCENE_WIDTH * 3 / 4 - step, GlobalConfig::SCENE_HEIGHT / 2},
+                     GlobalConfig::AREA_LIGHT_RADIUS};
+        renderer.render(scene, lights, &buffer);
+        step = (step + 1) % (GlobalConfig::SCENE_WIDTH / 2);
+        benchmark::DoNotOptimize(buffer.values.data());
+    }
+    state.counters["samples_per_light"] = static_cast<double>(renderer.lastSampleCount());
+}
+
+// Hundreds of ranged lights, a quarter of them drifting by a pixel per frame and every other
+// one a cone. Unbudgeted, every moved light is refreshed each frame; with the default budget the
+// scheduler spreads them over frames and the counters show how many waited.
+template <bool Budgeted>
+void BM_ManyLights(benchmark::State& state) {
+    constexpr int LIGHT_COUNT = 256;
+    constexpr int LIGHT_RADIUS = 80;
+    auto controller = makeScene(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    double budget =
+        Budgeted ? GlobalConfig::LIGHT_SCHEDULE_BUDGET_MS : std::numeric_limits<double>::infinity();
+    LightSchedulerNS::LightScheduler scheduler(budget);
+    RandomGenerator rng(SCENE_SEED);
+    for (int i = 0; i < LIGHT_COUNT; ++i) {
+        RangedLight light{
+            {rng.GenInt(0, GlobalConfig::SCENE_WIDTH), rng.GenInt(0, GlobalConfig::SCENE_HEIGHT)},
+            LIGHT_RADIUS};
+        if (i % 2 == 1) {
+            light.direction = rng.GenRealVector(1, 0.0, 2.0 * std::numbers::pi).front();
+            light.coneWidth = std::numbers::pi / 3.0;
+        }
+        scheduler.addLight(light);
+    }
+    scheduler.refresh(controller);
+    size_t refreshed = 0;
+    size_t skipped = 0;
+    int step = 0;
+    for (auto _ : state) {
+        for (size_t id = step % 4; id < scheduler.lightCount(); id += 4) {
+            RangedLight light = scheduler.getLight(id);
+            light.pos.x = (light.pos.x + 1) % GlobalConfig::SCENE_WIDTH;
+            scheduler.setLight(id, light);
+        }
+        auto stats = scheduler.refresh(controller);
+        refreshed += stats.refreshed;
+        skipped += stats.skipped;
+        ++step;
+    }
+    double frames = static_cast<double>(state.iterations());
+    state.counters["refreshed_per_frame"] = static_cast<double>(refreshed) / frames;
+    state.counters["skipped_per_frame"] = static_cast<double>(skipped) / frames;
+}
+
+// One frame of the light layer: a white light and three colored ones added into the float
+// buffer and toned to pixels. The areas are computed once, so only the scene's detail in them
+// shows up here.
+void BM_CompositeLights(benchmark::State& state) {
+    auto controller = makeScene(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    const std::vector<GeometryNS::Point> positions = {
+        {GlobalConfig::SCENE_WIDTH / 2 + 1, GlobalConfig::SCENE_HEIGHT / 2 + 1},
+        {GlobalConfig::SCENE_WIDTH / 4, GlobalConfig::SCENE_HEIGHT / 4},
+        {GlobalConfig::SCENE_WIDTH * 3 / 4, GlobalConfig::SCENE_HEIGHT / 4},
+        {GlobalConfig::SCENE_WIDTH / 2, GlobalConfig::SCENE_HEIGHT * 3 / 4}};
+    std::vector<std::vector<GeometryNS::Point>> areas(positions.size());
+    LightScratch scratch;
+    std::vector<LightBufferNS::LightLayer> layers;
+    for (size_t i = 0; i < positions.size(); ++i) {
+        controller.computeLightArea(positions[i], &scratch, &areas[i]);
+        layers.push_back({&areas[i], {1.0F, 0.6F + 0.1F * i, 0.4F}, 1.0F});
+    }
+    LightBufferNS::LightBuffer buffer;
+    buffer.resize(GlobalConfig::SCENE_WIDTH, GlobalConfig::SCENE_HEIGHT);
+    std::vector<uint32_t> pixels(static_cast<size_t>(buffer.getWidth()) * buffer.getHeight());
+    size_t vertices = 0;
+    for (const auto& area : areas) {
+        vertices += area.size();
+    }
+    for (auto _ : state) {
+        buffer.clear();
+        buffer.accumulate(layers);
+        buffer.toneMap(GlobalConfig::LIGHT_EXPOSURE, pixels.data(), buffer.getWidth());
+        benchmark::DoNotOptimize(pixels.data());
+    }
+    state.counters["area_vertices"] = static_cast<double>(vertices);
+}
+
+// The tone map alone over a full scene of light, once per instruction set.
+void BM_ToneMap(benchmark::State& state) {
+    auto isa = static_cast<CpuFeaturesNS::Isa>(state.range(0));
+    CpuFeaturesNS::Isa previous = LightBufferNS::activeToneMapIsa();
+    if (!LightBufferNS::selectToneMapIsa(isa)) {
+        state.SkipWithError("instruction set not supported by this CPU");
+        return;
+    }
+    std::vector<GeometryNS::Point> scene = {
+        {0, 0},
+        {GlobalConfig::SCENE_WIDTH, 0},
+        {GlobalConfig::SCENE_WIDTH, GlobalConfig::SCENE_HEIGHT},
+        {0, GlobalConfig::SCENE_HEIGHT}};
+    LightBufferNS::LightBuffer buffer;
+    buffer.resize(GlobalConfig::SCENE_WIDTH, GlobalConfig::SCENE_HEIGHT);
+    buffer.accumulate({{&scene, {1.0F, 0.5F, 0.25F}, 1.5F}});
+    std::vector<uint32_t> pixels(static_cast<size_t>(buffer.getWidth()) * buffer.getHeight());
+    for (auto _ : state) {
+        buffer.toneMap(GlobalConfig::LIGHT_EXPOSURE, pixels.data(), buffer.getWidth());
+        benchmark::DoNotOptimize(pixels.data());
+    }
+    state.SetLabel(CpuFeaturesNS::isaName(isa));
+    LightBufferNS::selectToneMapIsa(previous);
+}
+
+// Ray hits on one large convex polygon, vertices on a parabola, from a light below it; with
+// convex:0 the convexity flag is never set and every query scans all edges.
+void BM_ConvexRayHit(benchmark::State& state) {
+    constexpr int TARGET_COUNT = 256;
+    int half = static_cast<int>(state.range(0)) / 2;
+    std::vector<GeometryNS::Point> vertices;
+    for (int x = -half; x < half; ++x) {
+        vertices.push_back({x, x * x});
+    }
+    PolygonShapeNS::PolygonShape polygon(vertices);
+    if (state.range(1) != 0) {
+        polygon.updateConvexity();
+    }
+    RandomGenerator rng(SCENE_SEED);
+    GeometryNS::Point light{0, -1};
+    std::vector<RaySegmentNS::RaySegment> rays;
+    for (int i = 0; i < TARGET_COUNT; ++i) {
+        int x = rng.GenInt(-half, half);
+        rays.emplace_back(light, GeometryNS::Point{x, half * half});
+    }
+    size_t hits = 0;
+    size_t next = 0;
+    for (auto _ : state) {
+        auto hit = polygon.findRayIntersection(rays[next]);
+        hits += hit.has_value() ? 1 : 0;
+        next = (next + 1) % rays.size();
+        benchmark::DoNotOptimize(hit);
+    }
+    state.counters["hit_rate"] =
+        static_cast<double>(hits) / static_cast<double>(state.iterations());
+}
+
+// Steady-state mouse movement: the light walks a fixed path and every frame reuses one scratch
+// and one result buffer, after a lap that warms them up. lightarea_test checks that these
+// frames do not allocate.
+template <VisibilityEngine Engine>
+void BM_MoveLight(benchmark::State& state) {
+    constexpr int PATH_LENGTH = 64;
+    auto controller = makeScene(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    controller.setVisibilityEngine(Engine);
+    std::vector<GeometryNS::Point> path;
+    for (int i = 0; i < PATH_LENGTH; ++i) {
+        path.push_back(
+            {GlobalConfig::SCENE_WIDTH / 4 + i * 5, GlobalConfig::SCENE_HEIGHT / 3 + i * 3});
+    }
+    LightScratch scratch;
+    std::vector<GeometryNS::Point> area;
+    for (const auto& pt : path) {
+        controller.computeLightArea(pt, &scratch, &area);
+    }
+    size_t step = 0;
+    for (auto _ : state) {
+        controller.computeLightArea(path[step], &scratch, &area);
+        step = (step + 1) % path.size();
+        benchmark::DoNotOptimize(area.data());
+    }
+}
+
+BENCHMARK(BM_GenerateLightRays)->Apply(sceneSizes);
+BENCHMARK(BM_SortRaySegments)->Apply(sceneSizes);
+BENCHMARK(BM_ProcessRayIntersections)->Apply(sceneSizes);
+BENCHMARK(BM_FilterDuplicateRays)->Apply(sceneSizes);
+BENCHMARK(BM_ComputeLightArea<VisibilityEngine::RayCasting>)->Apply(sceneSizes);
+BENCHMARK(BM_ComputeLightArea<VisibilityEngine::AngularSweep>)->Apply(sceneSizes);
+BENCHMARK(BM_MoveLight<VisibilityEngine::RayCasting>)->Apply(sceneSizes);
+BENCHMARK(BM_MoveLight<VisibilityEngine::AngularSweep>)->Apply(sceneSizes);
+BENCHMARK(BM_HoverWithCache)->Apply(sceneSizes);
+BENCHMARK(BM_SoftShadows)->Apply(sceneSizes);
+BENCHMARK(BM_ManyLights<false>)->Apply(sceneSizes);
+BENCHMARK(BM_ManyLights<true>)->Apply(sceneSizes);
+BENCHMARK(BM_CompositeLights)->Apply(sceneSizes);
+BENCHMARK(BM_ToneMap)
+    ->ArgName("isa")
+    ->DenseRange(
+        static_cast<int>(CpuFeaturesNS::Isa::Scalar),
+        static_cast<int>(CpuFeaturesNS::Isa::Avx512))
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ConvexRayHit)
+    ->ArgNames({"vertices", "convex"})
+    ->ArgsProduct({{64, 1024, 16384}, {0, 1}})
+    ->Unit(benchmark::kNanosecond);
+
+}  // namespace
+
+// JSON on stdout unless the caller picked a format, so runs of two commits diff directly
+// (e.g. with tools/compare.py from google/benchmark).
+int main(int argc, char** argv) {
+    std::vector<char*> args(argv, argv + argc);
+    std::string jsonFormat = "--benchmark_format=json";
+    bool hasFormat = false;
+    for (int i = 1; i < argc; ++i) {
+        hasFormat = hasFormat || std::string(argv[i]).starts_with("--benchmark_format");
+    }
+    if (!hasFormat) {
+        args.push_back(jsonFormat.data());
+    }
+    int count = static_cast<int>(args.size());
+    benchmark::Initialize(&count, args.data());
+    if (benchmark::ReportUnrecognizedArguments(count, args.data())) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -1,11 +1,82 @@
 #include "canvas.h"
 
+#include "qtgeometry.h"
+
 #include <QPainter>
 #include <QPainterPath>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+
+namespace {
+
+constexpr int INTENSITY_LEVELS = 256;
+
+// Cells no sample sees stay clear; the rest blend from the shadow fill (barely lit) to the
+// light fill (fully lit).
+std::array<QRgb, INTENSITY_LEVELS> makeIntensityPalette() {
+    std::array<QRgb, INTENSITY_LEVELS> palette{};
+    const QColor& dim = GlobalColors::SHADOW_FILL;
+    const QColor& lit = GlobalColors::LIGHT_AREA_FILL;
+    for (int level = 1; level < INTENSITY_LEVELS; ++level) {
+        double f = static_cast<double>(level) / (INTENSITY_LEVELS - 1);
+        auto mix = [f](int from, int to) {
+            return static_cast<int>(std::lround(from + (to - from) * f));
+        };
+        palette[level] = qPremultiply(qRgba(
+            mix(dim.red(), lit.red()), mix(dim.green(), lit.green()), mix(dim.blue(), lit.blue()),
+            mix(dim.alpha(), lit.alpha())));
+    }
+    return palette;
+}
+
+void drawOccluder(QPainter* painter, const PolygonShapeNS::PolygonShape& poly) {
+    auto closedVerts = poly.closedVertices();
+    if (closedVerts.empty()) {
+        return;
+    }
+    QPainterPath polyPath;
+    polyPath.moveTo(toQPoint(poly.getVertices().front()));
+    for (size_t i = 1; i < poly.getVertices().size(); ++i) {
+        polyPath.lineTo(toQPoint(poly.getVertices()[i]));
+    }
+    polyPath.closeSubpath();
+    painter->fillPath(polyPath, QBrush(GlobalColors::FINISHED_FILL));
+    for (size_t i = 0; i < closedVerts.size() - 1; ++i) {
+        painter->drawLine(toQPoint(closedVerts[i]), toQPoint(closedVerts[i + 1]));
+    }
+}
+
+}  // namespace
 
 CanvasWidget::CanvasWidget(QWidget* parent)
-    : QWidget(parent), activeMode(RenderMode::Light), isDrawing(false), previewPt(0, 0) {
+    : QWidget(parent)
+    , activeMode(RenderMode::Light)
+    , isDrawing(false)
+    , previewPt{0, 0}
+    , staticCacheDirty(true)
+    , frameTimer(this)
+    , coalescedEvents(0)
+    , softShadows(false)
+    , pinnedColorIndex(0)
+    , lightWorker([this] {
+        QMetaObject::invokeMethod(this, [this] { update(); }, Qt::QueuedConnection);
+    }) {
     setMouseTracking(true);
+    controller.setFrameStats(&frameStats);
+    lightWorker.setFrameStats(&frameStats);
+    frameTimer.setTimerType(Qt::PreciseTimer);
+    setTargetFrameRate(GlobalConfig::TARGET_FRAME_RATE);
+    connect(&frameTimer, &QTimer::timeout, this, [this] {
+        if (pendingMove.has_value()) {
+            applyPendingMove();
+        } else {
+            frameTimer.stop();
+        }
+    });
+    requestLightArea();
 }
 
 void CanvasWidget::setRenderMode(RenderMode newMode) {
@@ -13,50 +84,91 @@ void CanvasWidget::setRenderMode(RenderMode newMode) {
         if (activeMode == RenderMode::Polygons && isDrawing) {
             controller.completePolygon();
             isDrawing = false;
+            invalidateStaticLayer();
         }
         activeMode = newMode;
+        requestLightArea();
         update();
     }
 }
 
+void CanvasWidget::setVisibilityEngine(VisibilityEngine engine) {
+    controller.setVisibilityEngine(engine);
+    sceneSnapshot.reset();
+    requestLightArea();
+    update();
+}
+
+void CanvasWidget::setSoftShadows(bool enabled) {
+    if (softShadows != enabled) {
+        softShadows = enabled;
+        requestLightArea();
+        update();
+    }
+}
+
+void CanvasWidget::setTargetFrameRate(int framesPerSecond) {
+    frameTimer.setInterval(1000 / std::max(1, framesPerSecond));
+}
+
+size_t CanvasWidget::coalescedEventCount() const {
+    return coalescedEvents;
+}
+
+const FrameStatsNS::FrameStats& CanvasWidget::getFrameStats() const {
+    return frameStats;
+}
+
+bool CanvasWidget::saveScene(const std::string& path, std::string* error) const {
+    return controller.saveScene(path, error);
+}
+
+bool CanvasWidget::loadScene(const std::string& path, std::string* error) {
+    if (!controller.loadScene(path, error)) {
+        return false;
+    }
+    isDrawing = false;
+    pendingMove.reset();
+    invalidateStaticLayer();
+    sceneSnapshot.reset();
+    requestLightArea();
+    update();
+    return true;
+}
+
 void CanvasWidget::paintEvent(QPaintEvent* /*event*/) {
+    FrameStatsNS::ScopedStageTimer paintTimer(&frameStats, FrameStatsNS::Stage::Paint);
+    frameStats.markFrame();
     QPainter painter(this);
-    painter.fillRect(rect(), GlobalColors::BG_COLOR);
+    painter.drawPixmap(0, 0, staticLayer());
     painter.setRenderHint(QPainter::Antialiasing);
     double scaleX = static_cast<double>(width()) / 800.0;
     double scaleY = static_cast<double>(height()) / 600.0;
     painter.scale(scaleX, scaleY);
     painter.setPen(GlobalColors::STROKE_COLOR);
-    for (const auto& poly : controller.getPolygons()) {
-        auto closedVerts = poly.closedVertices();
-        if (!closedVerts.empty()) {
-            QPainterPath polyPath;
-            polyPath.moveTo(poly.getVertices().front());
-            for (size_t i = 1; i < poly.getVertices().size(); ++i) {
-                polyPath.lineTo(poly.getVertices()[i]);
-            }
-            polyPath.closeSubpath();
-            painter.fillPath(polyPath, QBrush(GlobalColors::FINISHED_FILL));
-            for (size_t i = 0; i < closedVerts.size() - 1; ++i) {
-                painter.drawLine(closedVerts[i], closedVerts[i + 1]);
-            }
-        }
+    if (isDrawing && !controller.getPolygons().empty()) {
+        drawOccluder(&painter, controller.getPolygons().back());
     }
     if (activeMode == RenderMode::Light) {
         painter.setBrush(GlobalColors::LIGHT_COLOR);
         painter.setPen(Qt::NoPen);
-        QPoint lightPos = controller.getLightPosition();
+        QPoint lightPos = toQPoint(controller.getLightPosition());
         painter.drawEllipse(
             lightPos, GlobalConfig::LIGHT_DIAMETER / 2, GlobalConfig::LIGHT_DIAMETER / 2);
-        auto lightArea = controller.computeLightArea();
-        if (!lightArea.empty()) {
-            QPainterPath areaPath;
-            areaPath.moveTo(lightArea.front());
-            for (size_t i = 1; i < lightArea.size(); ++i) {
-                areaPath.lineTo(lightArea[i]);
-            }
-            areaPath.closeSubpath();
-            painter.fillPath(areaPath, QBrush(GlobalColors::LIGHT_AREA_FILL));
+        for (const auto& pinned : pinnedLights) {
+            painter.setBrush(
+                QColor::fromRgbF(pinned.color.r, pinned.color.g, pinned.color.b));
+            painter.drawEllipse(
+                toQPoint(pinned.pos), GlobalConfig::LIGHT_DIAMETER / 2,
+                GlobalConfig::LIGHT_DIAMETER / 2);
+        }
+        // Draws the newest finished frame; the worker repaints again when a fresher one lands.
+        // The frame copy keeps its storage from one paint to the next.
+        lightWorker.latestFrame(&paintedFrame);
+        if (paintedFrame.valid && paintedFrame.soft) {
+            drawIntensity(&painter);
+        } else if (paintedFrame.valid && !paintedFrame.pixels.empty()) {
+            drawLight(&painter);
         }
     } else if (activeMode == RenderMode::Polygons) {
         const auto& polys = controller.getPolygons();
@@ -66,42 +178,150 @@ void CanvasWidget::paintEvent(QPaintEvent* /*event*/) {
                 if (verts.size() >= 3) {
                     auto closedVerts = polys.back().closedVertices();
                     QPainterPath polyPath;
-                    polyPath.moveTo(closedVerts.front());
+                    polyPath.moveTo(toQPoint(closedVerts.front()));
                     for (size_t i = 1; i < closedVerts.size(); ++i) {
-                        polyPath.lineTo(closedVerts[i]);
+                        polyPath.lineTo(toQPoint(closedVerts[i]));
                     }
                     polyPath.closeSubpath();
                     painter.fillPath(polyPath, QBrush(GlobalColors::ACTIVE_FILL));
                     for (size_t i = 0; i < closedVerts.size() - 1; ++i) {
-                        painter.drawLine(closedVerts[i], closedVerts[i + 1]);
+                        painter.drawLine(toQPoint(closedVerts[i]), toQPoint(closedVerts[i + 1]));
                     }
                 } else {
                     for (size_t i = 0; i < verts.size() - 1; ++i) {
-                        painter.drawLine(verts[i], verts[i + 1]);
+                        painter.drawLine(toQPoint(verts[i]), toQPoint(verts[i + 1]));
                     }
-                    painter.drawLine(verts.back(), previewPt);
+                    painter.drawLine(toQPoint(verts.back()), toQPoint(previewPt));
                 }
             }
         }
     }
 }
 
+// Scene edits only happen outside of light mode, so the snapshot handed to the worker is
+// refreshed lazily: dropped on every edit and copied once on the next light request.
+void CanvasWidget::requestLightArea() {
+    if (activeMode != RenderMode::Light) {
+        sceneSnapshot.reset();
+        return;
+    }
+    if (!sceneSnapshot) {
+        sceneSnapshot = std::make_shared<const RaycasterController>(controller);
+    }
+    if (softShadows) {
+        std::vector<SoftShadowNS::AreaLight> lights;
+        for (const auto& pinned : pinnedLights) {
+            lights.push_back({pinned.pos, GlobalConfig::AREA_LIGHT_RADIUS});
+        }
+        lights.push_back({controller.getLightPosition(), GlobalConfig::AREA_LIGHT_RADIUS});
+        lightWorker.request(sceneSnapshot, std::move(lights));
+    } else {
+        lightWorker.request(sceneSnapshot, controller.getLightPosition(), pinnedLights);
+    }
+}
+
+void CanvasWidget::togglePinnedLight(const GeometryNS::Point& scenePos) {
+    auto under = std::ranges::find_if(pinnedLights, [&scenePos](const auto& light) {
+        return std::hypot(light.pos.x - scenePos.x, light.pos.y - scenePos.y) <=
+               GlobalConfig::AREA_LIGHT_RADIUS;
+    });
+    if (under != pinnedLights.end()) {
+        pinnedLights.erase(under);
+        return;
+    }
+    const auto& palette = GlobalColors::PINNED_LIGHT_COLORS;
+    const QColor& color = palette[pinnedColorIndex++ % std::size(palette)];
+    pinnedLights.push_back(
+        {scenePos,
+         {static_cast<float>(color.redF()), static_cast<float>(color.greenF()),
+          static_cast<float>(color.blueF())},
+         1.0F});
+}
+
+// The palette lookup stands in for per-pixel blending; Qt scales the buffer up to the scene
+// with smoothing, which also hides the cell grid.
+void CanvasWidget::drawIntensity(QPainter* painter) {
+    static const auto palette = makeIntensityPalette();
+    const auto& intensity = paintedFrame.intensity;
+    QSize bufferSize(intensity.width, intensity.height);
+    if (shadowImage.size() != bufferSize) {
+        shadowImage = QImage(bufferSize, QImage::Format_ARGB32_Premultiplied);
+    }
+    for (int y = 0; y < intensity.height; ++y) {
+        auto* line = reinterpret_cast<QRgb*>(shadowImage.scanLine(y));
+        const float* values = intensity.values.data() + static_cast<size_t>(y) * intensity.width;
+        for (int x = 0; x < intensity.width; ++x) {
+            int level = static_cast<int>(values[x] * (INTENSITY_LEVELS - 1) + 0.5F);
+            line[x] = palette[std::clamp(level, 0, INTENSITY_LEVELS - 1)];
+        }
+    }
+    painter->setRenderHint(QPainter::SmoothPixmapTransform);
+    painter->drawImage(
+        QRect(0, 0, intensity.width * intensity.cellSize, intensity.height * intensity.cellSize),
+        shadowImage);
+}
+
+// The worker has already added up and toned the lights, so this is one image draw however
+// many vertices their areas have; the image wraps the frame without a copy.
+void CanvasWidget::drawLight(QPainter* painter) {
+    QImage lightImage(
+        reinterpret_cast<const uchar*>(paintedFrame.pixels.data()), paintedFrame.width,
+        paintedFrame.height, static_cast<qsizetype>(paintedFrame.width) * sizeof(uint32_t),
+        QImage::Format_ARGB32_Premultiplied);
+    painter->setRenderHint(QPainter::SmoothPixmapTransform);
+    painter->drawImage(QRect(0, 0, paintedFrame.width, paintedFrame.height), lightImage);
+}
+
+void CanvasWidget::invalidateStaticLayer() {
+    staticCacheDirty = true;
+}
+
+const QPixmap& CanvasWidget::staticLayer() {
+    qreal pixelRatio = devicePixelRatioF();
+    QSize deviceSize = size() * pixelRatio;
+    if (!staticCacheDirty && staticCache.size() == deviceSize) {
+        return staticCache;
+    }
+    staticCache = QPixmap(deviceSize);
+    staticCache.setDevicePixelRatio(pixelRatio);
+    QPainter painter(&staticCache);
+    painter.fillRect(rect(), GlobalColors::BG_COLOR);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.scale(static_cast<double>(width()) / 800.0, static_cast<double>(height()) / 600.0);
+    painter.setPen(GlobalColors::STROKE_COLOR);
+    const auto& polys = controller.getPolygons();
+    size_t finished = isDrawing && !polys.empty() ? polys.size() - 1 : polys.size();
+    for (size_t i = 0; i < finished; ++i) {
+        drawOccluder(&painter, polys[i]);
+    }
+    staticCacheDirty = false;
+    return staticCache;
+}
+
 void CanvasWidget::resizeEvent(QResizeEvent* event) {
     QWidget::resizeEvent(event);
+    invalidateStaticLayer();
     update();
 }
 
-QPoint CanvasWidget::convertToScene(const QPoint& widgetPos) const {
+GeometryNS::Point CanvasWidget::convertToScene(const QPoint& widgetPos) const {
     double scaleX = static_cast<double>(width()) / 800.0;
     double scaleY = static_cast<double>(height()) / 600.0;
-    return QPoint(
-        static_cast<int>(widgetPos.x() / scaleX), static_cast<int>(widgetPos.y() / scaleY));
+    return {static_cast<int>(widgetPos.x() / scaleX), static_cast<int>(widgetPos.y() / scaleY)};
 }
 
 void CanvasWidget::mousePressEvent(QMouseEvent* event) {
-    QPoint scenePos = convertToScene(event->pos());
+    // A click must see the position the pointer moved to before it.
+    if (pendingMove.has_value()) {
+        applyPendingMove();
+    }
+    GeometryNS::Point scenePos = convertToScene(event->pos());
     if (activeMode == RenderMode::Light) {
-        controller.setLightPosition(scenePos);
+        if (event->button() == Qt::RightButton) {
+            togglePinnedLight(scenePos);
+        } else {
+            controller.setLightPosition(scenePos);
+        }
     } else if (activeMode == RenderMode::Polygons) {
         if (event->button() == Qt::LeftButton) {
             if (!isDrawing) {
@@ -115,17 +335,33 @@ void CanvasWidget::mousePressEvent(QMouseEvent* event) {
             isDrawing = false;
             controller.completePolygon();
         }
+        invalidateStaticLayer();
     }
+    requestLightArea();
     update();
 }
 
 void CanvasWidget::mouseMoveEvent(QMouseEvent* event) {
-    QPoint scenePos = convertToScene(event->pos());
+    if (pendingMove.has_value()) {
+        ++coalescedEvents;
+    }
+    pendingMove = convertToScene(event->pos());
+    if (!frameTimer.isActive()) {
+        // The first move after a pause is shown right away, the rest wait for the next tick.
+        applyPendingMove();
+        frameTimer.start();
+    }
+}
+
+void CanvasWidget::applyPendingMove() {
+    GeometryNS::Point scenePos = *pendingMove;
+    pendingMove.reset();
     if (activeMode == RenderMode::Light) {
         controller.setLightPosition(scenePos);
     } else if (activeMode == RenderMode::Polygons && isDrawing) {
         controller.updateCurrentPolygon(scenePos);
         previewPt = scenePos;
     }
+    requestLightArea();
     update();
 }
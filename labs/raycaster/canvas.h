@@ -1,20 +1,40 @@
 #ifndef CANVAS_H
 #define CANVAS_H
 
+#include "colors.h"
 #include "controller.h"
+#include "framestats.h"
+#include "geometry.h"
+#include "lightworker.h"
+#include "softshadow.h"
 #include "utils.h"
 
+#include <QImage>
 #include <QMouseEvent>
 #include <QPainter>
-#include <QPainterPath>
+#include <QPixmap>
 #include <QPoint>
 #include <QResizeEvent>
+#include <QTimer>
 #include <QWidget>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
 
 class CanvasWidget : public QWidget {
    public:
     explicit CanvasWidget(QWidget* parent = nullptr);
     void setRenderMode(RenderMode newMode);
+    void setVisibilityEngine(VisibilityEngine engine);
+    // Renders the light and the pinned lights as area lights with penumbrae.
+    void setSoftShadows(bool enabled);
+    void setTargetFrameRate(int framesPerSecond);
+    size_t coalescedEventCount() const;
+    const FrameStatsNS::FrameStats& getFrameStats() const;
+    bool saveScene(const std::string& path, std::string* error) const;
+    bool loadScene(const std::string& path, std::string* error);
 
    protected:
     void paintEvent(QPaintEvent* event) override;
@@ -23,11 +43,37 @@ class CanvasWidget : public QWidget {
     void mouseMoveEvent(QMouseEvent* event) override;
 
    private:
-    QPoint convertToScene(const QPoint& widgetPos) const;
+    GeometryNS::Point convertToScene(const QPoint& widgetPos) const;
+    void requestLightArea();
+    void togglePinnedLight(const GeometryNS::Point& scenePos);
+    void drawIntensity(QPainter* painter);
+    void drawLight(QPainter* painter);
+    void applyPendingMove();
+    void invalidateStaticLayer();
+    const QPixmap& staticLayer();
     RenderMode activeMode;
+    FrameStatsNS::FrameStats frameStats;
     RaycasterController controller;
     bool isDrawing;
-    QPoint previewPt;
+    GeometryNS::Point previewPt;
+    // Background and finished polygons, rendered at device resolution and reused until the
+    // scene or the widget size changes. The polygon being drawn stays out of it.
+    QPixmap staticCache;
+    bool staticCacheDirty;
+    // Mouse moves only record the newest position; frameTimer applies it at most once a frame.
+    QTimer frameTimer;
+    std::optional<GeometryNS::Point> pendingMove;
+    size_t coalescedEvents;
+    LightWorkerNS::LightWorker::Snapshot sceneSnapshot;
+    LightWorkerNS::LightFrame paintedFrame;
+    bool softShadows;
+    // In light mode a right click pins a light or unpins the one under the cursor.
+    std::vector<LightWorkerNS::PointLight> pinnedLights;
+    size_t pinnedColorIndex;
+    // Intensity of the painted frame, at the resolution of its buffer.
+    QImage shadowImage;
+    // Declared last so that the thread is joined before the rest of the widget goes away.
+    LightWorkerNS::LightWorker lightWorker;
 };
 
 #endif  // CANVAS_H
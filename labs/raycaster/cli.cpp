@@ -0,0 +1,233 @@
+#include "controller.h"
+#include "geometry.h"
+#include "scenefile.h"
+#include "workerpool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Batch visibility: loads a scene, computes the light area for every requested light position
+// on all cores and streams the polygons out in query order.
+//
+// Binary output (host byte order):
+//   char[4] "RCVB", uint32 version, uint64 query count, then per query
+//   int32 light x, int32 light y, uint32 vertex count, vertex count x (int32 x, int32 y).
+// CSV output: one line per query, "light_x,light_y,vertex_count,x0,y0,x1,y1,...".
+
+namespace {
+
+constexpr size_t BATCH_SIZE = 1024;
+constexpr uint32_t BINARY_VERSION = 1;
+
+enum class OutputFormat { Csv, Binary };
+
+struct Options {
+    std::string scenePath;
+    std::string lightsPath;
+    std::string gridSpec;
+    std::string outputPath;
+    VisibilityEngine engine = VisibilityEngine::AngularSweep;
+    OutputFormat format = OutputFormat::Csv;
+};
+
+void printUsage() {
+    std::cerr << "usage: raycaster_cli SCENE (--lights FILE | --grid X0,Y0,X1,Y1,STEP)\n"
+                 "                     [--engine sweep|rays] [--format csv|bin] [--output FILE]\n"
+                 "  SCENE    binary .rcs scene or text, one polygon per line: x1 y1 x2 y2 ...\n"
+                 "  --lights light positions, one \"x y\" pair per line\n"
+                 "  --grid   every STEP pixels in the rectangle [X0, X1] x [Y0, Y1]\n";
+}
+
+std::optional<Options> parseOptions(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--lights" && hasValue) {
+            options.lightsPath = argv[++i];
+        } else if (arg == "--grid" && hasValue) {
+            options.gridSpec = argv[++i];
+        } else if (arg == "--output" && hasValue) {
+            options.outputPath = argv[++i];
+        } else if (arg == "--engine" && hasValue) {
+            std::string value = argv[++i];
+            if (value != "sweep" && value != "rays") {
+                return std::nullopt;
+            }
+            options.engine =
+                value == "sweep" ? VisibilityEngine::AngularSweep : VisibilityEngine::RayCasting;
+        } else if (arg == "--format" && hasValue) {
+            std::string value = argv[++i];
+            if (value != "csv" && value != "bin") {
+                return std::nullopt;
+            }
+            options.format = value == "csv" ? OutputFormat::Csv : OutputFormat::Binary;
+        } else if (!arg.starts_with("--") && options.scenePath.empty()) {
+            options.scenePath = arg;
+        } else {
+            return std::nullopt;
+        }
+    }
+    if (options.scenePath.empty() || options.lightsPath.empty() == options.gridSpec.empty()) {
+        return std::nullopt;
+    }
+    return options;
+}
+
+std::optional<std::vector<GeometryNS::Point>> readLights(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        return std::nullopt;
+    }
+    std::vector<GeometryNS::Point> lights;
+    GeometryNS::Point pt{};
+    while (file >> pt.x >> pt.y) {
+        lights.push_back(pt);
+    }
+    if (!file.eof()) {
+        return std::nullopt;
+    }
+    return lights;
+}
+
+std::optional<std::vector<GeometryNS::Point>> gridLights(const std::string& spec) {
+    std::istringstream fields(spec);
+    int x0 = 0;
+    int y0 = 0;
+    int x1 = 0;
+    int y1 = 0;
+    int step = 0;
+    char sep[4] = {};
+    if (!(fields >> x0 >> sep[0] >> y0 >> sep[1] >> x1 >> sep[2] >> y1 >> sep[3] >> step) ||
+        std::ranges::any_of(sep, [](char c) { return c != ','; }) || step <= 0 || x1 < x0 ||
+        y1 < y0) {
+        return std::nullopt;
+    }
+    std::vector<GeometryNS::Point> lights;
+    for (int y = y0; y <= y1; y += step) {
+        for (int x = x0; x <= x1; x += step) {
+            lights.push_back({x, y});
+        }
+    }
+    return lights;
+}
+
+template <class T>
+void writeRaw(std::ostream& out, T value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void writeRecord(
+    std::ostream& out, OutputFormat format, const GeometryNS::Point& light,
+    const std::vector<GeometryNS::Point>& area) {
+    if (format == OutputFormat::Binary) {
+        writeRaw<int32_t>(out, light.x);
+        writeRaw<int32_t>(out, light.y);
+        writeRaw<uint32_t>(out, static_cast<uint32_t>(area.size()));
+        for (const auto& pt : area) {
+            writeRaw<int32_t>(out, pt.x);
+            writeRaw<int32_t>(out, pt.y);
+        }
+        return;
+    }
+    out << light.x << ',' << light.y << ',' << area.size();
+    for (const auto& pt : area) {
+        out << ',' << pt.x << ',' << pt.y;
+    }
+    out << '\n';
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    auto options = parseOptions(argc, argv);
+    if (!options.has_value()) {
+        printUsage();
+        return 2;
+    }
+
+    RaycasterController controller;
+    std::string error;
+    if (SceneFileNS::isBinaryScene(options->scenePath)) {
+        if (!controller.loadScene(options->scenePath, &error)) {
+            std::cerr << "raycaster_cli: " << error << "\n";
+            return 1;
+        }
+    } else {
+        auto polygons = SceneFileNS::readTextScene(options->scenePath, &error);
+        if (!polygons.has_value()) {
+            std::cerr << "raycaster_cli: " << error << "\n";
+            return 1;
+        }
+        for (const auto& polygon : *polygons) {
+            controller.addPolygon(polygon);
+        }
+    }
+    auto lights = options->lightsPath.empty() ? gridLights(options->gridSpec)
+                                              : readLights(options->lightsPath);
+    if (!lights.has_value()) {
+        std::cerr << "raycaster_cli: bad light positions\n";
+        return 1;
+    }
+
+    std::ofstream file;
+    if (!options->outputPath.empty()) {
+        file.open(options->outputPath, std::ios::binary);
+        if (!file) {
+            std::cerr << "raycaster_cli: cannot write " << options->outputPath << "\n";
+            return 1;
+        }
+    }
+    std::ostream& out = options->outputPath.empty() ? std::cout : file;
+
+    controller.setVisibilityEngine(options->engine);
+    // Queries are spread over the pool, so each one runs its rays serially.
+    controller.setParallelEnabled(false);
+
+    if (options->format == OutputFormat::Binary) {
+        out.write("RCVB", 4);
+        writeRaw<uint32_t>(out, BINARY_VERSION);
+        writeRaw<uint64_t>(out, lights->size());
+    }
+
+    auto& pool = WorkerPoolNS::WorkerPool::shared();
+    std::vector<std::vector<GeometryNS::Point>> areas(BATCH_SIZE);
+    std::chrono::duration<double> computeTime{0};
+    auto started = std::chrono::steady_clock::now();
+    for (size_t first = 0; first < lights->size(); first += BATCH_SIZE) {
+        size_t count = std::min(BATCH_SIZE, lights->size() - first);
+        auto batchStarted = std::chrono::steady_clock::now();
+        pool.parallelFor(count, [&](size_t begin, size_t end) {
+            // One scratch per pool thread; it and the area slots are reused across batches.
+            thread_local LightScratch scratch;
+            for (size_t i = begin; i < end; ++i) {
+                controller.computeLightArea((*lights)[first + i], &scratch, &areas[i]);
+            }
+        });
+        computeTime += std::chrono::steady_clock::now() - batchStarted;
+        for (size_t i = 0; i < count; ++i) {
+            writeRecord(out, options->format, (*lights)[first + i], areas[i]);
+        }
+    }
+    out.flush();
+    std::chrono::duration<double> totalTime = std::chrono::steady_clock::now() - started;
+    if (!out) {
+        std::cerr << "raycaster_cli: write failed\n";
+        return 1;
+    }
+
+    double queries = static_cast<double>(lights->size());
+    std::fprintf(
+        stderr, "%zu queries on %zu threads: %.3f s total, %.0f queries/s (compute only %.0f)\n",
+        lights->size(), pool.concurrency(), totalTime.count(),
+        queries / std::max(totalTime.count(), 1e-9), queries / std::max(computeTime.count(), 1e-9));
+    return 0;
+}
@@ -0,0 +1,19 @@
+#ifndef COLORS_H
+#define COLORS_H
+
+#include <QColor>
+
+namespace GlobalColors {
+const QColor BG_COLOR(9, 9, 46);
+const QColor FINISHED_FILL(Qt::black);
+const QColor ACTIVE_FILL(QColor(89, 20, 89, 100));
+const QColor STROKE_COLOR(Qt::white);
+const QColor LIGHT_COLOR(Qt::red);
+const QColor LIGHT_AREA_FILL(255, 255, 255, 200);
+const QColor SHADOW_FILL(255, 255, 255, 30);
+// Pinned lights take these in turn.
+const QColor PINNED_LIGHT_COLORS[] = {
+    QColor(255, 170, 80), QColor(90, 160, 255), QColor(120, 230, 120), QColor(240, 100, 200)};
+}  // namespace GlobalColors
+
+#endif  // COLORS_H
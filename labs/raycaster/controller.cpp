@@ -1,89 +1,432 @@
 #include "controller.h"
 
+#include "scenefile.h"
+#include "sweepline.h"
+#include "utils.h"
+#include "workerpool.h"
+
 #include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
 #include <limits>
 #include <optional>
 
+namespace {
+
+constexpr auto CLOCKWISE = GeometryNS::smallRotation(-GlobalConfig::ROTATION_DELTA);
+constexpr auto COUNTER_CLOCKWISE = GeometryNS::smallRotation(GlobalConfig::ROTATION_DELTA);
+
+// One process-wide counter, so two controllers only share a generation when one is a copy of
+// the other.
+uint64_t nextSceneGeneration() {
+    static std::atomic<uint64_t> counter{0};
+    return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+// Calls visit(vertex, silhouette) for the vertices of the scene that can be seen from the light,
+// in polygon order, and returns how many rays are left out: the two offset rays of a vertex off
+// the silhouette, and all three for a vertex on the far side of a convex polygon, which the
+// polygon itself hides. Only the facing chain of a convex polygon is walked.
+template <class Visit>
+size_t forEachLightVertex(
+    const std::vector<PolygonShapeNS::PolygonShape>& polygons, const GeometryNS::Point& light,
+    Visit visit) {
+    size_t skippedRays = 0;
+    for (const auto& poly : polygons) {
+        const auto& vertices = poly.getVertices();
+        size_t count = vertices.size();
+        auto visitRange = [&](size_t from, size_t to) {
+            for (size_t i = from; i < to; ++i) {
+                const auto& prev = vertices[(i + count - 1) % count];
+                const auto& next = vertices[(i + 1) % count];
+                bool silhouette = isSilhouetteVertex(light, prev, vertices[i], next);
+                if (!silhouette) {
+                    skippedRays += 2;
+                }
+                visit(vertices[i], silhouette);
+            }
+        };
+        auto chain = poly.facingChain(light);
+        if (!chain.has_value()) {
+            visitRange(0, count);
+            continue;
+        }
+        auto [first, last] = *chain;
+        skippedRays += 3 * (count - (last + count - first) % count - 1);
+        if (first <= last) {
+            visitRange(first, last + 1);
+        } else {
+            visitRange(0, last + 1);
+            visitRange(first, count);
+        }
+    }
+    return skippedRays;
+}
+
+// Ray parameter at which the ray enters the box, infinity when it misses it.
+double boxEntryParam(const GeometryNS::Box& box, const IntersectKernelNS::RayParams& ray) {
+    double tEnter = 0.0;
+    double tLeave = std::numeric_limits<double>::infinity();
+    auto clipAxis = [&](double from, double dir, double lo, double hi) {
+        if (dir == 0.0) {
+            return from >= lo && from <= hi;
+        }
+        double t1 = (lo - from) / dir;
+        double t2 = (hi - from) / dir;
+        tEnter = std::max(tEnter, std::min(t1, t2));
+        tLeave = std::min(tLeave, std::max(t1, t2));
+        return tEnter <= tLeave;
+    };
+    if (!clipAxis(ray.ox, ray.dx, box.min.x, box.max.x) ||
+        !clipAxis(ray.oy, ray.dy, box.min.y, box.max.y)) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return tEnter;
+}
+
+}  // namespace
+
 RaycasterController::RaycasterController()
-    : lightPos(0, 0), currentMode(RenderMode::Light), constructing(false) {
+    : lightPos{0, 0}
+    , currentMode(RenderMode::Light)
+    , constructing(false)
+    , visibilityEngine(VisibilityEngine::AngularSweep)
+    , parallelEnabled(true)
+    , parallelThreshold(GlobalConfig::PARALLEL_RAY_THRESHOLD)
+    , frameStats(nullptr)
+    , sceneGeneration(nextSceneGeneration()) {
     PolygonShapeNS::PolygonShape border(
-        {QPoint(0, 0), QPoint(800, 0), QPoint(800, 600), QPoint(0, 600)});
+        {{0, 0},
+         {GlobalConfig::SCENE_WIDTH, 0},
+         {GlobalConfig::SCENE_WIDTH, GlobalConfig::SCENE_HEIGHT},
+         {0, GlobalConfig::SCENE_HEIGHT}});
     polygonList.push_back(border);
+    syncPolygon(0);
 }
 
-void RaycasterController::beginPolygon(const QPoint& initPt) {
+void RaycasterController::beginPolygon(const GeometryNS::Point& initPt) {
+    completePolygon();
     currentPolygon = PolygonShapeNS::PolygonShape();
     currentPolygon.addVertex(initPt);
     currentPolygon.addVertex(initPt);
     polygonList.push_back(currentPolygon);
     constructing = true;
+    syncPolygon(polygonList.size() - 1);
 }
 
-void RaycasterController::appendVertex(const QPoint& pt) {
+void RaycasterController::appendVertex(const GeometryNS::Point& pt) {
     if (!polygonList.empty()) {
         polygonList.back().addVertex(pt);
+        syncPolygon(polygonList.size() - 1);
     }
 }
 
-void RaycasterController::updateCurrentPolygon(const QPoint& pt) {
+void RaycasterController::updateCurrentPolygon(const GeometryNS::Point& pt) {
     if (!polygonList.empty()) {
         polygonList.back().updateLastVertex(pt);
+        syncPolygon(polygonList.size() - 1);
     }
 }
 
 void RaycasterController::completePolygon() {
+    bool finished = constructing && !polygonList.empty();
     constructing = false;
+    if (finished) {
+        sceneGeneration = nextSceneGeneration();
+        size_t polygonId = polygonList.size() - 1;
+        if (!spatialIndex.insertPolygon(polygonId, edgeStore)) {
+            spatialIndex.rebuild(edgeStore);
+        }
+        classifyPolygon(polygonId);
+    }
+}
+
+// Adds a finished polygon in one step, e.g. when a scene comes from a file.
+void RaycasterController::addPolygon(const std::vector<GeometryNS::Point>& vertices) {
+    completePolygon();
+    polygonList.emplace_back(vertices);
+    syncPolygon(polygonList.size() - 1);
+}
+
+bool RaycasterController::saveScene(const std::string& path, std::string* error) const {
+    size_t finished = constructing ? polygonList.size() - 1 : polygonList.size();
+    std::vector<SceneFileNS::Polygon> polygons;
+    for (size_t i = 1; i < finished; ++i) {
+        polygons.push_back(polygonList[i].getVertices());
+    }
+    return SceneFileNS::writeBinaryScene(path, polygons, error);
+}
+
+// Replaces everything but the border and indexes the new scene in one pass.
+bool RaycasterController::loadScene(const std::string& path, std::string* error) {
+    SceneFileNS::MappedScene scene;
+    if (!scene.open(path, error)) {
+        return false;
+    }
+    polygonList.resize(1);
+    polygonList.reserve(scene.polygonCount() + 1);
+    for (size_t i = 0; i < scene.polygonCount(); ++i) {
+        auto vertices = scene.polygon(i);
+        polygonList.emplace_back(std::vector<GeometryNS::Point>(vertices.begin(), vertices.end()));
+    }
+    constructing = false;
+    edgeStore.rebuild(polygonList);
+    spatialIndex.rebuild(edgeStore);
+    polygonOrientations.clear();
+    for (size_t id = 0; id < polygonList.size(); ++id) {
+        classifyPolygon(id);
+    }
+    sceneGeneration = nextSceneGeneration();
+    return true;
+}
+
+// Patches the edge store after polygonList[polygonId] changed. The polygon under construction
+// follows the cursor on every mouse move, so it stays out of the grid until completePolygon()
+// and is scanned directly from its contiguous edge range instead.
+void RaycasterController::syncPolygon(size_t polygonId) {
+    sceneGeneration = nextSceneGeneration();
+    std::optional<size_t> skipped;
+    if (constructing) {
+        skipped = polygonList.size() - 1;
+    }
+    bool indexed = skipped != polygonId;
+    if (indexed) {
+        spatialIndex.removePolygon(polygonId, edgeStore);
+    }
+    bool shifted = edgeStore.patchPolygon(polygonId, polygonList[polygonId]);
+    if (shifted || (indexed && !spatialIndex.insertPolygon(polygonId, edgeStore))) {
+        spatialIndex.rebuild(edgeStore, skipped);
+    }
+    classifyPolygon(polygonId);
+}
+
+// The orientation check is quadratic in the vertex count (linear for convex polygons), so it
+// runs when a polygon enters the grid rather than on every move of the vertex being placed.
+void RaycasterController::classifyPolygon(size_t polygonId) {
+    if (polygonOrientations.size() < polygonList.size()) {
+        polygonOrientations.resize(polygonList.size(), 0);
+    }
+    auto& polygon = polygonList[polygonId];
+    if (constructing && polygonId == polygonList.size() - 1) {
+        polygonOrientations[polygonId] = 0;
+        return;
+    }
+    polygon.updateConvexity();
+    polygonOrientations[polygonId] = polygon.simpleOrientation();
+}
+
+// A ray from outside a simple polygon first meets it on an edge that has the light on its
+// exterior side; a ray from inside (the scene border) leaves through an edge with the light on
+// its interior side. Edges of the other kind can never be a nearest hit and are dropped from
+// this frame's cell lists. Polygons that are not simple, or that the light sits on, keep all
+// their edges.
+void RaycasterController::cullBackFaces(
+    const GeometryNS::Point& srcPos, LightScratch* scratch) const {
+    auto& mask = scratch->edgeMask;
+    mask.assign(edgeStore.size(), 1);
+    auto light = GeometryNS::toPointF(srcPos);
+    for (size_t id = 0; id < polygonOrientations.size(); ++id) {
+        int orientation = polygonOrientations[id];
+        if (orientation == 0) {
+            continue;
+        }
+        size_t firstEdge = edgeStore.firstEdge(id);
+        if (auto chain = polygonList[id].facingChain(srcPos); chain.has_value()) {
+            // Only the edges between the two tangent vertices face the light.
+            size_t count = edgeStore.lastEdge(id) - firstEdge;
+            std::fill_n(mask.begin() + firstEdge, count, 0);
+            for (size_t i = chain->first; i != chain->second; i = (i + 1) % count) {
+                mask[firstEdge + i] = 1;
+            }
+            continue;
+        }
+        auto location = polygonList[id].locatePoint(srcPos);
+        if (location == PolygonShapeNS::PointLocation::Boundary) {
+            continue;
+        }
+        // Positive when the light is on the interior side of an edge.
+        double facing = location == PolygonShapeNS::PointLocation::Inside ? -orientation
+                                                                          : orientation;
+        for (size_t i = firstEdge; i < edgeStore.lastEdge(id); ++i) {
+            GeometryNS::PointF start = edgeStore.startPoint(i);
+            GeometryNS::PointF edge = edgeStore.endPoint(i) - start;
+            double side = edge.x * (light.y - start.y) - edge.y * (light.x - start.x);
+            mask[i] = side * facing <= 0 ? 1 : 0;
+        }
+    }
+    // Filtering copies every cell list, which is still cheaper than testing the mask per edge
+    // on every ray's walk. The lists only change with the mask or the scene, so a light that
+    // moved without crossing the line of any edge keeps last frame's.
+    if (scratch->visibleCellsGeneration == sceneGeneration && scratch->visibleCellsMask == mask) {
+        return;
+    }
+    spatialIndex.filterCells(mask, &scratch->visibleCells);
+    scratch->visibleCellsMask = mask;
+    scratch->visibleCellsGeneration = sceneGeneration;
 }
 
 const std::vector<PolygonShapeNS::PolygonShape>& RaycasterController::getPolygons() const {
     return polygonList;
 }
 
-QPoint RaycasterController::getLightPosition() const {
+GeometryNS::Point RaycasterController::getLightPosition() const {
     return lightPos;
 }
 
-void RaycasterController::setLightPosition(const QPoint& pt) {
+void RaycasterController::setLightPosition(const GeometryNS::Point& pt) {
     lightPos = pt;
 }
 
 std::vector<RaySegmentNS::RaySegment> RaycasterController::generateLightRays(
-    const QPoint& srcPos) const {
+    const GeometryNS::Point& srcPos) const {
     std::vector<RaySegmentNS::RaySegment> rays;
-    for (const auto& poly : polygonList) {
-        for (const auto& vertex : poly.getVertices()) {
-            RaySegmentNS::RaySegment baseRay(srcPos, vertex);
-            rays.push_back(baseRay);
-            rays.push_back(baseRay.rotated(-GlobalConfig::ROTATION_DELTA));
-            rays.push_back(baseRay.rotated(GlobalConfig::ROTATION_DELTA));
-        }
-    }
+    collectLightRays(srcPos, &rays);
     sortRaySegmentsByDirection(&rays);
     return rays;
 }
 
+// The offset rays turn the base direction by a rotation matrix fixed at compile time and are
+// only cast past silhouette vertices. Returns the number of offset rays left out.
+size_t RaycasterController::collectLightRays(
+    const GeometryNS::Point& srcPos, std::vector<RaySegmentNS::RaySegment>* rays) const {
+    rays->clear();
+    return forEachLightVertex(polygonList, srcPos, [&](const auto& vertex, bool silhouette) {
+        RaySegmentNS::RaySegment baseRay(srcPos, vertex);
+        rays->push_back(baseRay);
+        if (silhouette) {
+            rays->push_back(baseRay.rotated(CLOCKWISE));
+            rays->push_back(baseRay.rotated(COUNTER_CLOCKWISE));
+        }
+    });
+}
+
+// The same fan as collectLightRays, as bare directions from srcPos.
+size_t RaycasterController::collectRayDirections(
+    const GeometryNS::Point& srcPos, std::vector<GeometryNS::PointF>* directions) const {
+    directions->clear();
+    return forEachLightVertex(polygonList, srcPos, [&](const auto& vertex, bool silhouette) {
+        GeometryNS::PointF base =
+            vertex == srcPos ? GeometryNS::PointF{1.0, 0.0} : GeometryNS::toPointF(vertex - srcPos);
+        directions->push_back(base);
+        if (silhouette) {
+            directions->push_back(GeometryNS::rotate(base, CLOCKWISE));
+            directions->push_back(GeometryNS::rotate(base, COUNTER_CLOCKWISE));
+        }
+    });
+}
+
 std::vector<RaySegmentNS::RaySegment> RaycasterController::generateLightRays() const {
     return generateLightRays(lightPos);
 }
 
+// Every ray only reads the scene and writes its own end point, so chunks of the sorted array
+// are traced on the shared worker pool once there are enough rays to pay for the hand-off.
 void RaycasterController::processRayIntersections(
     std::vector<RaySegmentNS::RaySegment>* rays) const {
-    for (auto& ray : *rays) {
-        double minDist = std::numeric_limits<double>::infinity();
-        std::optional<QPoint> bestIntersection;
-        for (const auto& poly : polygonList) {
-            if (auto intersect = poly.findRayIntersection(ray); intersect.has_value()) {
-                double dist = calcDistance(ray.getStart(), *intersect);
-                if (dist < minDist) {
-                    minDist = dist;
-                    bestIntersection = intersect;
-                }
-            }
+    auto traceRange = [this, rays](size_t begin, size_t end) {
+        size_t edgeTests = 0;
+        for (size_t i = begin; i < end; ++i) {
+            edgeTests += traceRay(&(*rays)[i]);
+        }
+        if (frameStats != nullptr) {
+            frameStats->addCount(FrameStatsNS::Counter::EdgeTests, edgeTests);
         }
-        if (bestIntersection.has_value()) {
-            ray.setEnd(*bestIntersection);
+    };
+    if (parallelEnabled && rays->size() >= parallelThreshold) {
+        WorkerPoolNS::WorkerPool::shared().parallelFor(rays->size(), traceRange);
+    } else {
+        traceRange(0, rays->size());
+    }
+}
+
+size_t RaycasterController::traceRay(RaySegmentNS::RaySegment* ray) const {
+    const auto& dir = ray->getDirectionVector();
+    IntersectKernelNS::RayParams params{
+        static_cast<double>(ray->getStart().x), static_cast<double>(ray->getStart().y), dir.x,
+        dir.y};
+    GeometryNS::Point end = ray->getEnd();
+    size_t edgeTests = traceRay(params, nullptr, &end);
+    ray->setEnd(end);
+    return edgeTests;
+}
+
+// Sets *end to the nearest hit and leaves it alone if there is none. Returns the number of
+// edges the ray was tested against.
+size_t RaycasterController::traceRay(
+    const IntersectKernelNS::RayParams& params, const SpatialGridNS::CellView* view,
+    GeometryNS::Point* end) const {
+    size_t edgeTests = 0;
+    auto best = spatialIndex.findNearestHit(params, edgeStore, view, &edgeTests);
+    // The polygon being drawn is scanned edge by edge, unless its box starts behind the hit.
+    if (constructing &&
+        boxEntryParam(polygonList.back().getBounds(), params) <= best.t + GlobalConfig::EPSILON) {
+        size_t polygonId = polygonList.size() - 1;
+        size_t from = edgeStore.firstEdge(polygonId);
+        size_t to = edgeStore.lastEdge(polygonId);
+        auto hit = edgeStore.nearestHit(params, from, to);
+        edgeTests += to - from;
+        if (hit.t < best.t) {
+            best = hit;
+        }
+    }
+    if (best.edge != IntersectKernelNS::NO_EDGE) {
+        *end = GeometryNS::Point{
+            static_cast<int>(params.ox + params.dx * best.t),
+            static_cast<int>(params.oy + params.dy * best.t)};
+    }
+    return edgeTests;
+}
+
+// Traces the rays in sorted order and drops near-duplicate end points on the way, so every ray
+// is touched once after the sort and only the kept points are written. Large fans are traced
+// on the pool into rayEnds first and merged in a second pass over those 8-byte points.
+void RaycasterController::traceSortedRays(
+    const GeometryNS::Point& srcPos, LightScratch* scratch,
+    std::vector<GeometryNS::Point>* area) const {
+    const auto& directions = scratch->rayDirections;
+    const auto& keys = scratch->sortKeys;
+    auto origin = GeometryNS::toPointF(srcPos);
+    // A ray that hits nothing (light outside the border) ends where its direction points.
+    auto traceKey = [&](const RaySortKey& key, size_t* edgeTests) {
+        const auto& dir = directions[key.index];
+        GeometryNS::Point end = GeometryNS::truncated(origin + dir);
+        *edgeTests += traceRay({origin.x, origin.y, dir.x, dir.y}, &scratch->visibleCells, &end);
+        return end;
+    };
+    auto keep = [area](const GeometryNS::Point& end) {
+        if (area->empty() || !isSameEndpoint(area->back(), end)) {
+            area->push_back(end);
+        }
+    };
+    area->clear();
+    size_t edgeTests = 0;
+    if (!parallelEnabled || keys.size() < parallelThreshold) {
+        for (const auto& key : keys) {
+            keep(traceKey(key, &edgeTests));
+        }
+    } else {
+        auto& ends = scratch->rayEnds;
+        ends.resize(keys.size());
+        std::atomic<size_t> totalTests{0};
+        auto traceChunk = [&](size_t begin, size_t end) {
+            size_t chunkTests = 0;
+            for (size_t i = begin; i < end; ++i) {
+                ends[i] = traceKey(keys[i], &chunkTests);
+            }
+            totalTests.fetch_add(chunkTests, std::memory_order_relaxed);
+        };
+        // Wrapped so that the std::function holds one reference and stays off the heap.
+        WorkerPoolNS::WorkerPool::shared().parallelFor(
+            keys.size(), [&traceChunk](size_t begin, size_t end) { traceChunk(begin, end); });
+        edgeTests = totalTests.load(std::memory_order_relaxed);
+        for (const auto& end : ends) {
+            keep(end);
         }
     }
+    if (frameStats != nullptr) {
+        frameStats->addCount(FrameStatsNS::Counter::EdgeTests, edgeTests);
+    }
 }
 
 void RaycasterController::filterDuplicateRays(std::vector<RaySegmentNS::RaySegment>* rays) const {
@@ -93,18 +436,189 @@ void RaycasterController::filterDuplicateRays(std::vector<RaySegmentNS::RaySegme
     auto newEnd = std::unique(
         rays->begin(), rays->end(),
         [](const RaySegmentNS::RaySegment& a, const RaySegmentNS::RaySegment& b) {
-            return (calcDistance(a.getEnd(), b.getEnd()) < GlobalConfig::ENDPOINT_TOLERANCE);
+            return isSameEndpoint(a.getEnd(), b.getEnd());
         });
     rays->erase(newEnd, rays->end());
 }
 
-std::vector<QPoint> RaycasterController::computeLightArea() const {
-    auto rays = generateLightRays();
-    processRayIntersections(&rays);
-    filterDuplicateRays(&rays);
-    std::vector<QPoint> area;
-    for (const auto& ray : rays) {
-        area.push_back(ray.getEnd());
-    }
+std::vector<GeometryNS::Point> RaycasterController::computeLightArea(
+    const GeometryNS::Point& srcPos) const {
+    LightScratch scratch;
+    std::vector<GeometryNS::Point> area;
+    computeLightArea(srcPos, &scratch, &area);
     return area;
 }
+
+std::vector<GeometryNS::Point> RaycasterController::computeLightArea() const {
+    return computeLightArea(lightPos);
+}
+
+// The sweep has no separate stages and is reported as intersection time as a whole.
+void RaycasterController::computeLightArea(
+    const GeometryNS::Point& srcPos, LightScratch* scratch,
+    std::vector<GeometryNS::Point>* area) const {
+    using FrameStatsNS::ScopedStageTimer;
+    using FrameStatsNS::Stage;
+    if (frameStats != nullptr) {
+        frameStats->addCount(FrameStatsNS::Counter::LightAreas, 1);
+    }
+    if (visibilityEngine == VisibilityEngine::AngularSweep) {
+        ScopedStageTimer timer(frameStats, Stage::Intersection);
+        SweepLineNS::computeVisibility(
+            srcPos, edgeStore, sceneGeneration, &scratch->sweep, area);
+        return;
+    }
+    size_t skippedRays = 0;
+    {
+        ScopedStageTimer timer(frameStats, Stage::RayGeneration);
+        skippedRays = collectRayDirections(
+            srcPos, &scratch->rayDirections);
+        cullBackFaces(srcPos, scratch);
+    }
+    if (frameStats != nullptr) {
+        frameStats->addCount(FrameStatsNS::Counter::RaysGenerated, scratch->rayDirections.size());
+        frameStats->addCount(FrameStatsNS::Counter::RaysSkipped, skippedRays);
+    }
+    {
+        ScopedStageTimer timer(frameStats, Stage::Sorting);
+        sortDirections(scratch->rayDirections, &scratch->sortKeys, &scratch->sortSpare);
+    }
+    // Near-duplicate end points are dropped while tracing, so their cost is part of intersection.
+    {
+        ScopedStageTimer timer(frameStats, Stage::Intersection);
+        traceSortedRays(srcPos, scratch, area);
+    }
+}
+
+// Rays go to every vertex in reach and to every point where an edge leaves the disc, each with
+// its two offset rays, and to evenly spaced points of the circle. Directions are sorted from
+// the start of the cone, so a cone never wraps around the seam of the angular order.
+void RaycasterController::computeRangedLightArea(
+    const RangedLight& light, LightScratch* scratch, std::vector<GeometryNS::Point>* area) const {
+    area->clear();
+    if (light.radius <= 0 || light.coneWidth <= 0.0) {
+        return;
+    }
+    double radius = light.radius;
+    GeometryNS::PointF origin = GeometryNS::toPointF(light.pos);
+    GeometryNS::Point reach{light.radius, light.radius};
+    auto& edges = scratch->rangeEdges;
+    spatialIndex.collectEdges({light.pos - reach, light.pos + reach}, &edges);
+    if (constructing) {
+        size_t polygonId = polygonList.size() - 1;
+        for (size_t i = edgeStore.firstEdge(polygonId); i < edgeStore.lastEdge(polygonId); ++i) {
+            edges.push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    bool cone = light.coneWidth < 2.0 * std::numbers::pi;
+    double coneStart = light.direction - (cone ? light.coneWidth / 2.0 : std::numbers::pi);
+    GeometryNS::Rotation toCone{std::cos(coneStart), -std::sin(coneStart)};
+    GeometryNS::Rotation fromCone{std::cos(coneStart), std::sin(coneStart)};
+    double sweep = cone ? light.coneWidth : 2.0 * std::numbers::pi;
+    double coneEnd = cone ? GeometryNS::pseudoAngle({std::cos(sweep), std::sin(sweep)}) : 4.0;
+    auto& directions = scratch->rayDirections;
+    auto& keys = scratch->sortKeys;
+    directions.clear();
+    keys.clear();
+    // local is the direction as seen from the cone start; its pseudo-angle is the sort key.
+    auto addLocal = [&](const GeometryNS::PointF& local) {
+        double length = std::hypot(local.x, local.y);
+        double angle = GeometryNS::pseudoAngle(local) + 0.0;
+        if (length < GlobalConfig::EPSILON || angle > coneEnd) {
+            return;
+        }
+        keys.push_back(
+            {std::bit_cast<uint64_t>(angle), static_cast<uint32_t>(directions.size())});
+        directions.push_back(GeometryNS::rotate(local, fromCone) * (radius / length));
+    };
+    auto addWithOffsets = [&](const GeometryNS::PointF& dir) {
+        GeometryNS::PointF local = GeometryNS::rotate(dir, toCone);
+        addLocal(local);
+        addLocal(GeometryNS::rotate(local, CLOCKWISE));
+        addLocal(GeometryNS::rotate(local, COUNTER_CLOCKWISE));
+    };
+    double radiusSquared = radius * radius;
+    for (uint32_t edge : edges) {
+        GeometryNS::PointF start = edgeStore.startPoint(edge) - origin;
+        GeometryNS::PointF along = edgeStore.endPoint(edge) - edgeStore.startPoint(edge);
+        if (start.x * start.x + start.y * start.y <= radiusSquared) {
+            addWithOffsets(start);
+        }
+        // Where start + s * along meets the circle, for s in [0, 1].
+        double a = along.x * along.x + along.y * along.y;
+        double b = start.x * along.x + start.y * along.y;
+        double c = start.x * start.x + start.y * start.y - radiusSquared;
+        double discriminant = b * b - a * c;
+        if (a < GlobalConfig::EPSILON || discriminant < 0.0) {
+            continue;
+        }
+        for (double s : {(-b - std::sqrt(discriminant)) / a, (-b + std::sqrt(discriminant)) / a}) {
+            if (s >= 0.0 && s <= 1.0) {
+                addWithOffsets(start + along * s);
+            }
+        }
+    }
+    auto arcSteps = static_cast<size_t>(
+        std::max(4.0, std::ceil(sweep * radius / GlobalConfig::LIGHT_ARC_STEP)));
+    // The last step of a full circle is the first one again.
+    for (size_t i = 0; i < (cone ? arcSteps + 1 : arcSteps); ++i) {
+        double angle = sweep * static_cast<double>(i) / static_cast<double>(arcSteps);
+        addLocal({std::cos(angle), std::sin(angle)});
+    }
+    radixSortKeys(&keys, &scratch->sortSpare);
+
+    if (cone) {
+        area->push_back(light.pos);
+    }
+    for (const auto& key : keys) {
+        const auto& dir = directions[key.index];
+        IntersectKernelNS::RayParams params{origin.x, origin.y, dir.x, dir.y};
+        auto best = spatialIndex.findNearestHit(params, edgeStore, nullptr, nullptr, 1.0);
+        if (constructing) {
+            size_t polygonId = polygonList.size() - 1;
+            auto hit = edgeStore.nearestHit(
+                params, edgeStore.firstEdge(polygonId), edgeStore.lastEdge(polygonId));
+            best.t = std::min(best.t, hit.t);
+        }
+        double t = std::min(best.t, 1.0);
+        GeometryNS::Point end = GeometryNS::truncated(origin + dir * t);
+        if (area->empty() || !isSameEndpoint(area->back(), end)) {
+            area->push_back(end);
+        }
+    }
+    if (area->size() > 1 && isSameEndpoint(area->front(), area->back())) {
+        area->pop_back();
+    }
+}
+
+VisibilityEngine RaycasterController::getVisibilityEngine() const {
+    return visibilityEngine;
+}
+
+void RaycasterController::setVisibilityEngine(VisibilityEngine engine) {
+    if (visibilityEngine != engine) {
+        visibilityEngine = engine;
+        sceneGeneration = nextSceneGeneration();
+    }
+}
+
+bool RaycasterController::isParallelEnabled() const {
+    return parallelEnabled;
+}
+
+void RaycasterController::setParallelEnabled(bool enabled) {
+    parallelEnabled = enabled;
+}
+
+void RaycasterController::setParallelThreshold(size_t minRays) {
+    parallelThreshold = minRays;
+}
+
+void RaycasterController::setFrameStats(FrameStatsNS::FrameStats* stats) {
+    frameStats = stats;
+}
+
+uint64_t RaycasterController::getSceneGeneration() const {
+    return sceneGeneration;
+}
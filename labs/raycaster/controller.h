@@ -1,38 +1,129 @@
 #ifndef CONTROLLER_H
 #define CONTROLLER_H
 
+#include "edgestore.h"
+#include "framestats.h"
 #include "functions.h"
+#include "geometry.h"
 #include "polygon.h"
 #include "ray.h"
+#include "spatialgrid.h"
+#include "sweepline.h"
 
-#include <QPoint>
+#include <cstdint>
+#include <numbers>
 #include <optional>
+#include <string>
 #include <vector>
 
 enum class RenderMode { Light, Polygons };
 
+enum class VisibilityEngine { AngularSweep, RayCasting };
+
+// A point light that reaches radius pixels, optionally limited to a cone of coneWidth radians
+// centered on direction (scene coordinates, y down, angles from +x towards +y).
+struct RangedLight {
+    GeometryNS::Point pos;
+    int radius;
+    double direction = 0.0;
+    double coneWidth = 2.0 * std::numbers::pi;
+
+    bool operator==(const RangedLight& other) const = default;
+};
+
+// Buffers computeLightArea works in. They keep their capacity between calls, so once they have
+// grown to fit the scene a query does not touch the heap. The controller itself stays read-only
+// during a query and may be shared between threads; every thread brings its own scratch.
+// The ray engine keeps one direction per ray (the origin is the light for all of them), the sort
+// keys, end points only where rays are traced in parallel, the grid cells without the edges
+// that face away from the light (with the mask and scene they were filtered for), and the edges
+// around a ranged light.
+struct LightScratch {
+    std::vector<GeometryNS::PointF> rayDirections;
+    std::vector<RaySortKey> sortKeys;
+    std::vector<RaySortKey> sortSpare;
+    std::vector<GeometryNS::Point> rayEnds;
+    std::vector<uint8_t> edgeMask;
+    SpatialGridNS::CellView visibleCells;
+    std::vector<uint8_t> visibleCellsMask;
+    uint64_t visibleCellsGeneration = 0;
+    std::vector<uint32_t> rangeEdges;
+    SweepLineNS::SweepScratch sweep;
+};
+
 class RaycasterController {
    public:
     RaycasterController();
-    void beginPolygon(const QPoint& initPt);
-    void appendVertex(const QPoint& pt);
-    void updateCurrentPolygon(const QPoint& pt);
+    void beginPolygon(const GeometryNS::Point& initPt);
+    void appendVertex(const GeometryNS::Point& pt);
+    void updateCurrentPolygon(const GeometryNS::Point& pt);
     void completePolygon();
+    void addPolygon(const std::vector<GeometryNS::Point>& vertices);
+    // Binary scene files (scenefile.h). The scene border is not stored; a polygon that is
+    // still being drawn is not saved.
+    bool saveScene(const std::string& path, std::string* error) const;
+    bool loadScene(const std::string& path, std::string* error);
     const std::vector<PolygonShapeNS::PolygonShape>& getPolygons() const;
-    QPoint getLightPosition() const;
-    void setLightPosition(const QPoint& pt);
-    std::vector<RaySegmentNS::RaySegment> generateLightRays(const QPoint& srcPos) const;
+    GeometryNS::Point getLightPosition() const;
+    void setLightPosition(const GeometryNS::Point& pt);
+    std::vector<RaySegmentNS::RaySegment> generateLightRays(const GeometryNS::Point& srcPos) const;
     std::vector<RaySegmentNS::RaySegment> generateLightRays() const;
     void processRayIntersections(std::vector<RaySegmentNS::RaySegment>* rays) const;
     void filterDuplicateRays(std::vector<RaySegmentNS::RaySegment>* rays) const;
-    std::vector<QPoint> computeLightArea() const;
+    std::vector<GeometryNS::Point> computeLightArea(const GeometryNS::Point& srcPos) const;
+    std::vector<GeometryNS::Point> computeLightArea() const;
+    // Overwrites *area; allocates only while the scratch and *area are still growing.
+    void computeLightArea(
+        const GeometryNS::Point& srcPos, LightScratch* scratch,
+        std::vector<GeometryNS::Point>* area) const;
+    // The part of the light area within reach of a ranged light, the cone apex included when
+    // there is a cone. Always traced with rays on the calling thread, whatever the engine; only
+    // the grid cells under the light's disc are read and every ray stops at the radius. The
+    // circle is followed by chords of about GlobalConfig::LIGHT_ARC_STEP pixels.
+    void computeRangedLightArea(
+        const RangedLight& light, LightScratch* scratch,
+        std::vector<GeometryNS::Point>* area) const;
+    VisibilityEngine getVisibilityEngine() const;
+    void setVisibilityEngine(VisibilityEngine engine);
+    bool isParallelEnabled() const;
+    void setParallelEnabled(bool enabled);
+    void setParallelThreshold(size_t minRays);
+    // Stage timings and counters of computeLightArea go to stats; nullptr turns them off.
+    void setFrameStats(FrameStatsNS::FrameStats* stats);
+    // Changes whenever the light area for a given position could change: on every scene edit
+    // and on an engine switch. A copy of the controller keeps the generation of the original.
+    uint64_t getSceneGeneration() const;
 
    private:
+    void syncPolygon(size_t polygonId);
+    void classifyPolygon(size_t polygonId);
+    void cullBackFaces(const GeometryNS::Point& srcPos, LightScratch* scratch) const;
+    size_t collectLightRays(
+        const GeometryNS::Point& srcPos, std::vector<RaySegmentNS::RaySegment>* rays) const;
+    size_t collectRayDirections(
+        const GeometryNS::Point& srcPos, std::vector<GeometryNS::PointF>* directions) const;
+    void traceSortedRays(
+        const GeometryNS::Point& srcPos, LightScratch* scratch,
+        std::vector<GeometryNS::Point>* area) const;
+    size_t traceRay(RaySegmentNS::RaySegment* ray) const;
+    size_t traceRay(
+        const IntersectKernelNS::RayParams& params, const SpatialGridNS::CellView* view,
+        GeometryNS::Point* end) const;
+
     std::vector<PolygonShapeNS::PolygonShape> polygonList;
     PolygonShapeNS::PolygonShape currentPolygon;
-    QPoint lightPos;
+    GeometryNS::Point lightPos;
     RenderMode currentMode;
     bool constructing;
+    VisibilityEngine visibilityEngine;
+    bool parallelEnabled;
+    size_t parallelThreshold;
+    FrameStatsNS::FrameStats* frameStats;
+    EdgeStoreNS::EdgeStore edgeStore;
+    SpatialGridNS::SpatialGrid spatialIndex;
+    // PolygonShape::simpleOrientation() of every indexed polygon, 0 for the one being drawn.
+    std::vector<int> polygonOrientations;
+    uint64_t sceneGeneration;
 };
 
 #endif  // CONTROLLER_H
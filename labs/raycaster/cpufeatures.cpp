@@ -0,0 +1,53 @@
+#include "cpufeatures.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define RAYCASTER_X86_KERNELS 1
+#endif
+
+namespace CpuFeaturesNS {
+
+namespace {
+
+Isa detectIsa() {
+#ifdef RAYCASTER_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return Isa::Avx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return Isa::Avx2;
+    }
+    return Isa::Sse2;
+#else
+    return Isa::Scalar;
+#endif
+}
+
+}  // namespace
+
+// A function-local static, so that kernel tables in other files may use it while they are
+// initialized themselves.
+Isa bestSupportedIsa() {
+    static const Isa supported = detectIsa();
+    return supported;
+}
+
+bool isSupported(Isa isa) {
+    return static_cast<int>(isa) <= static_cast<int>(bestSupportedIsa());
+}
+
+const char* isaName(Isa isa) {
+    switch (isa) {
+        case Isa::Avx512:
+            return "avx512";
+        case Isa::Avx2:
+            return "avx2";
+        case Isa::Sse2:
+            return "sse2";
+        case Isa::Scalar:
+            break;
+    }
+    return "scalar";
+}
+
+}  // namespace CpuFeaturesNS
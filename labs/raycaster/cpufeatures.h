@@ -0,0 +1,16 @@
+#ifndef CPUFEATURES_H
+#define CPUFEATURES_H
+
+namespace CpuFeaturesNS {
+
+// Vector instruction sets the kernels come in, narrowest first.
+enum class Isa { Scalar, Sse2, Avx2, Avx512 };
+
+// Widest instruction set this CPU runs, detected on first use.
+Isa bestSupportedIsa();
+bool isSupported(Isa isa);
+const char* isaName(Isa isa);
+
+}  // namespace CpuFeaturesNS
+
+#endif  // CPUFEATURES_H
@@ -0,0 +1,129 @@
+#include "edgestore.h"
+
+#include <algorithm>
+
+namespace EdgeStoreNS {
+
+namespace {
+
+size_t edgeCountOf(const std::vector<GeometryNS::Point>& vertices) {
+    return vertices.size() >= 2 ? vertices.size() : 0;
+}
+
+}  // namespace
+
+void EdgeStore::rebuild(const std::vector<PolygonShapeNS::PolygonShape>& polygons) {
+    clear();
+    for (size_t id = 0; id < polygons.size(); ++id) {
+        patchPolygon(id, polygons[id]);
+    }
+}
+
+// Returns true when the edge count changed and the edges of later polygons were moved.
+bool EdgeStore::patchPolygon(size_t polygonId, const PolygonShapeNS::PolygonShape& polygon) {
+    const auto& verts = polygon.getVertices();
+    size_t newCount = edgeCountOf(verts);
+    if (polygonId == polygonCount()) {
+        offsets.push_back(offsets.back());
+    }
+    size_t at = offsets[polygonId];
+    size_t oldCount = offsets[polygonId + 1] - at;
+    bool shifted = false;
+    if (newCount != oldCount) {
+        resizeRange(at, oldCount, newCount);
+        for (size_t id = polygonId + 1; id < offsets.size(); ++id) {
+            offsets[id] = offsets[id] - oldCount + newCount;
+        }
+        shifted = polygonId + 1 < polygonCount();
+    }
+    writeEdges(polygonId, at, verts);
+    return shifted;
+}
+
+void EdgeStore::clear() {
+    startX.clear();
+    startY.clear();
+    dx.clear();
+    dy.clear();
+    polygonIds.clear();
+    offsets.assign(1, 0);
+}
+
+size_t EdgeStore::size() const {
+    return startX.size();
+}
+
+size_t EdgeStore::polygonCount() const {
+    return offsets.size() - 1;
+}
+
+size_t EdgeStore::firstEdge(size_t polygonId) const {
+    return offsets[polygonId];
+}
+
+size_t EdgeStore::lastEdge(size_t polygonId) const {
+    return offsets[polygonId + 1];
+}
+
+GeometryNS::PointF EdgeStore::startPoint(size_t i) const {
+    return {startX[i], startY[i]};
+}
+
+GeometryNS::PointF EdgeStore::endPoint(size_t i) const {
+    return {startX[i] + dx[i], startY[i] + dy[i]};
+}
+
+size_t EdgeStore::polygonOf(size_t i) const {
+    return polygonIds[i];
+}
+
+IntersectKernelNS::EdgeArrays EdgeStore::arrays() const {
+    return {startX.data(), startY.data(), dx.data(), dy.data()};
+}
+
+IntersectKernelNS::EdgeHit EdgeStore::nearestHit(
+    const IntersectKernelNS::RayParams& ray, size_t from, size_t to) const {
+    return IntersectKernelNS::nearestInRange(arrays(), ray, from, to);
+}
+
+IntersectKernelNS::EdgeHit EdgeStore::nearestHit(
+    const IntersectKernelNS::RayParams& ray, const std::vector<uint32_t>& indices) const {
+    return IntersectKernelNS::nearestInList(arrays(), ray, indices.data(), indices.size());
+}
+
+IntersectKernelNS::EdgeHit EdgeStore::nearestHit(
+    const IntersectKernelNS::RayParams& ray, const uint32_t* indices, size_t count) const {
+    return IntersectKernelNS::nearestInList(arrays(), ray, indices, count);
+}
+
+void EdgeStore::resizeRange(size_t at, size_t oldCount, size_t newCount) {
+    auto resize = [at, oldCount, newCount](auto& column) {
+        auto pos = column.begin() + static_cast<std::ptrdiff_t>(at + std::min(oldCount, newCount));
+        if (newCount > oldCount) {
+            column.insert(pos, newCount - oldCount, {});
+        } else {
+            column.erase(pos, pos + static_cast<std::ptrdiff_t>(oldCount - newCount));
+        }
+    };
+    resize(startX);
+    resize(startY);
+    resize(dx);
+    resize(dy);
+    resize(polygonIds);
+}
+
+void EdgeStore::writeEdges(
+    size_t polygon, size_t at, const std::vector<GeometryNS::Point>& vertices) {
+    size_t count = edgeCountOf(vertices);
+    for (size_t k = 0; k < count; ++k) {
+        const GeometryNS::Point& ptA = vertices[k];
+        const GeometryNS::Point& ptB = vertices[(k + 1) % count];
+        startX[at + k] = ptA.x;
+        startY[at + k] = ptA.y;
+        dx[at + k] = ptB.x - ptA.x;
+        dy[at + k] = ptB.y - ptA.y;
+        polygonIds[at + k] = static_cast<uint32_t>(polygon);
+    }
+}
+
+}  // namespace EdgeStoreNS
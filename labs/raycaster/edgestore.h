@@ -0,0 +1,50 @@
+#ifndef EDGESTORE_H
+#define EDGESTORE_H
+
+#include "geometry.h"
+#include "intersectkernel.h"
+#include "polygon.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace EdgeStoreNS {
+
+// Structure-of-arrays copy of every polygon edge in the scene. The edges of one polygon are
+// contiguous and polygons are stored in polygonList order, so a full scan streams linearly.
+class EdgeStore {
+   public:
+    void rebuild(const std::vector<PolygonShapeNS::PolygonShape>& polygons);
+    bool patchPolygon(size_t polygonId, const PolygonShapeNS::PolygonShape& polygon);
+    void clear();
+    size_t size() const;
+    size_t polygonCount() const;
+    size_t firstEdge(size_t polygonId) const;
+    size_t lastEdge(size_t polygonId) const;
+    GeometryNS::PointF startPoint(size_t i) const;
+    GeometryNS::PointF endPoint(size_t i) const;
+    size_t polygonOf(size_t i) const;
+    IntersectKernelNS::EdgeArrays arrays() const;
+    IntersectKernelNS::EdgeHit nearestHit(
+        const IntersectKernelNS::RayParams& ray, size_t from, size_t to) const;
+    IntersectKernelNS::EdgeHit nearestHit(
+        const IntersectKernelNS::RayParams& ray, const std::vector<uint32_t>& indices) const;
+    IntersectKernelNS::EdgeHit nearestHit(
+        const IntersectKernelNS::RayParams& ray, const uint32_t* indices, size_t count) const;
+
+   private:
+    void resizeRange(size_t at, size_t oldCount, size_t newCount);
+    void writeEdges(size_t polygon, size_t at, const std::vector<GeometryNS::Point>& vertices);
+
+    std::vector<double> startX;
+    std::vector<double> startY;
+    std::vector<double> dx;
+    std::vector<double> dy;
+    std::vector<uint32_t> polygonIds;
+    std::vector<size_t> offsets{0};
+};
+
+}  // namespace EdgeStoreNS
+
+#endif  // EDGESTORE_H
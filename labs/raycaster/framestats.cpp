@@ -0,0 +1,210 @@
+#include "framestats.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+namespace FrameStatsNS {
+
+namespace {
+
+constexpr auto FPS_WINDOW = std::chrono::seconds(1);
+
+size_t indexOf(Stage stage) {
+    return static_cast<size_t>(stage);
+}
+
+size_t indexOf(Counter counter) {
+    return static_cast<size_t>(counter);
+}
+
+}  // namespace
+
+const char* stageName(Stage stage) {
+    switch (stage) {
+        case Stage::RayGeneration:
+            return "ray generation";
+        case Stage::Sorting:
+            return "sorting";
+        case Stage::Intersection:
+            return "intersection";
+        case Stage::Composite:
+            return "composite";
+        case Stage::ToneMap:
+            return "tone map";
+        case Stage::Paint:
+            return "paint";
+        case Stage::Count:
+            break;
+    }
+    return "unknown";
+}
+
+const char* counterName(Counter counter) {
+    switch (counter) {
+        case Counter::RaysGenerated:
+            return "rays generated";
+        case Counter::RaysSkipped:
+            return "rays skipped";
+        case Counter::EdgeTests:
+            return "edge tests";
+        case Counter::LightSamples:
+            return "light samples";
+        case Counter::LightsRefreshed:
+            return "lights refreshed";
+        case Counter::LightUpdatesSkipped:
+            return "light updates skipped";
+        case Counter::LightAreas:
+            return "light areas";
+        case Counter::CacheHits:
+            return "cache hits";
+        case Counter::CacheMisses:
+            return "cache misses";
+        case Counter::Frames:
+            return "frames";
+        case Counter::Count:
+            break;
+    }
+    return "unknown";
+}
+
+void RollingHistogram::add(double value) {
+    if (samples.size() < CAPACITY) {
+        samples.push_back(value);
+        return;
+    }
+    samples[next] = value;
+    next = (next + 1) % CAPACITY;
+}
+
+size_t RollingHistogram::count() const {
+    return samples.size();
+}
+
+double RollingHistogram::percentile(double fraction) const {
+    if (samples.empty()) {
+        return 0.0;
+    }
+    std::vector<double> sorted = samples;
+    size_t rank = static_cast<size_t>(fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+    auto nth = sorted.begin() + static_cast<std::ptrdiff_t>(rank);
+    std::nth_element(sorted.begin(), nth, sorted.end());
+    return sorted[rank];
+}
+
+void FrameStats::record(Stage stage, double milliseconds) {
+    std::lock_guard lock(statsMutex);
+    stages[indexOf(stage)].add(milliseconds);
+}
+
+void FrameStats::addCount(Counter counter, uint64_t amount) {
+    std::lock_guard lock(statsMutex);
+    counters[indexOf(counter)] += amount;
+}
+
+void FrameStats::markFrame() {
+    auto now = Clock::now();
+    std::lock_guard lock(statsMutex);
+    ++counters[indexOf(Counter::Frames)];
+    recentFrames.push_back(now);
+    while (now - recentFrames.front() > FPS_WINDOW) {
+        recentFrames.pop_front();
+    }
+}
+
+double FrameStats::percentile(Stage stage, double fraction) const {
+    std::lock_guard lock(statsMutex);
+    return stages[indexOf(stage)].percentile(fraction);
+}
+
+uint64_t FrameStats::count(Counter counter) const {
+    std::lock_guard lock(statsMutex);
+    return counters[indexOf(counter)];
+}
+
+// Frames painted during the last second; drops to zero while nothing changes on screen.
+double FrameStats::framesPerSecond() const {
+    auto now = Clock::now();
+    std::lock_guard lock(statsMutex);
+    return static_cast<double>(std::ranges::count_if(
+        recentFrames, [now](Clock::time_point t) { return now - t <= FPS_WINDOW; }));
+}
+
+std::string FrameStats::summary() const {
+    double fps = framesPerSecond();
+    double paint = percentile(Stage::Paint, 0.95);
+    double geometry = 0.0;
+    for (size_t i = 0; i < indexOf(Stage::Paint); ++i) {
+        geometry += percentile(static_cast<Stage>(i), 0.95);
+    }
+    char text[96];
+    std::snprintf(
+        text, sizeof(text), "FPS: %.0f | p95 light %.2f ms, paint %.2f ms", fps, geometry, paint);
+    return text;
+}
+
+std::string FrameStats::report() const {
+    std::string out = "stage                p50 ms     p95 ms     p99 ms    samples\n";
+    char line[128];
+    for (size_t i = 0; i < indexOf(Stage::Count); ++i) {
+        auto stage = static_cast<Stage>(i);
+        size_t samples = 0;
+        {
+            std::lock_guard lock(statsMutex);
+            samples = stages[i].count();
+        }
+        std::snprintf(
+            line, sizeof(line), "%-16s %10.3f %10.3f %10.3f %10zu\n", stageName(stage),
+            percentile(stage, 0.50), percentile(stage, 0.95), percentile(stage, 0.99), samples);
+        out += line;
+    }
+    out += "\n";
+    for (size_t i = 0; i < indexOf(Counter::Count); ++i) {
+        auto counter = static_cast<Counter>(i);
+        std::snprintf(
+            line, sizeof(line), "%-16s %llu\n", counterName(counter),
+            static_cast<unsigned long long>(count(counter)));
+        out += line;
+    }
+    // Rays a full three-per-vertex fan would have cast over the rays actually traced.
+    uint64_t generated = count(Counter::RaysGenerated);
+    if (generated > 0) {
+        double fullFan = static_cast<double>(generated + count(Counter::RaysSkipped));
+        std::snprintf(
+            line, sizeof(line), "%-16s %.2fx\n", "ray reduction",
+            fullFan / static_cast<double>(generated));
+        out += line;
+    }
+    uint64_t lookups = count(Counter::CacheHits) + count(Counter::CacheMisses);
+    if (lookups > 0) {
+        std::snprintf(
+            line, sizeof(line), "%-16s %.1f%%\n", "cache hit rate",
+            100.0 * static_cast<double>(count(Counter::CacheHits)) /
+                static_cast<double>(lookups));
+        out += line;
+    }
+    return out;
+}
+
+bool FrameStats::dumpToFile(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file) {
+        return false;
+    }
+    file << report();
+    return static_cast<bool>(file);
+}
+
+ScopedStageTimer::ScopedStageTimer(FrameStats* frameStats, Stage timedStage)
+    : stats(frameStats), stage(timedStage), started(std::chrono::steady_clock::now()) {
+}
+
+ScopedStageTimer::~ScopedStageTimer() {
+    if (stats != nullptr) {
+        std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - started;
+        stats->record(stage, elapsed.count());
+    }
+}
+
+}  // namespace FrameStatsNS
@@ -0,0 +1,97 @@
+#ifndef FRAMESTATS_H
+#define FRAMESTATS_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace FrameStatsNS {
+
+enum class Stage {
+    RayGeneration,
+    Sorting,
+    Intersection,
+    Composite,
+    ToneMap,
+    Paint,
+    Count
+};
+
+enum class Counter {
+    RaysGenerated,
+    RaysSkipped,
+    EdgeTests,
+    LightSamples,
+    LightsRefreshed,
+    LightUpdatesSkipped,
+    LightAreas,
+    CacheHits,
+    CacheMisses,
+    Frames,
+    Count
+};
+
+const char* stageName(Stage stage);
+const char* counterName(Counter counter);
+
+// Keeps the last CAPACITY samples; percentiles are taken over that window only, so a slow
+// frame stops showing up once enough fast ones have followed it.
+class RollingHistogram {
+   public:
+    static constexpr size_t CAPACITY = 512;
+
+    void add(double value);
+    size_t count() const;
+    double percentile(double fraction) const;
+
+   private:
+    std::vector<double> samples;
+    size_t next = 0;
+};
+
+// Per-stage timings and counters shared by the GUI thread (paint) and the light worker
+// (geometry). All methods are thread-safe.
+class FrameStats {
+   public:
+    void record(Stage stage, double milliseconds);
+    void addCount(Counter counter, uint64_t amount);
+    void markFrame();
+
+    double percentile(Stage stage, double fraction) const;
+    uint64_t count(Counter counter) const;
+    double framesPerSecond() const;
+    std::string summary() const;
+    std::string report() const;
+    bool dumpToFile(const std::string& path) const;
+
+   private:
+    using Clock = std::chrono::steady_clock;
+
+    mutable std::mutex statsMutex;
+    std::array<RollingHistogram, static_cast<size_t>(Stage::Count)> stages;
+    std::array<uint64_t, static_cast<size_t>(Counter::Count)> counters{};
+    std::deque<Clock::time_point> recentFrames;
+};
+
+// Adds the lifetime of the scope to a stage; does nothing without a stats object.
+class ScopedStageTimer {
+   public:
+    ScopedStageTimer(FrameStats* frameStats, Stage timedStage);
+    ~ScopedStageTimer();
+    ScopedStageTimer(const ScopedStageTimer&) = delete;
+    ScopedStageTimer& operator=(const ScopedStageTimer&) = delete;
+
+   private:
+    FrameStats* stats;
+    Stage stage;
+    std::chrono::steady_clock::time_point started;
+};
+
+}  // namespace FrameStatsNS
+
+#endif  // FRAMESTATS_H
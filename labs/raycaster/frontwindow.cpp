@@ -3,10 +3,16 @@
 #include "canvas.h"
 #include "utils.h"
 
+#include <QCheckBox>
 #include <QComboBox>
+#include <QFileDialog>
 #include <QHBoxLayout>
+#include <QMessageBox>
 #include <QPushButton>
+#include <QString>
+#include <QTimer>
 #include <QVBoxLayout>
+#include <string>
 
 QWidget* createMainWindow() {
     QWidget* mainWin = new QWidget;
@@ -25,10 +31,23 @@ QWidget* createMainWindow() {
     modeSwitcher->addItem("Polygons");
     topLayout->addWidget(modeSwitcher, 0, Qt::AlignLeft);
 
+    QComboBox* engineSwitcher = new QComboBox(topPanel);
+    engineSwitcher->addItem("Angular sweep");
+    engineSwitcher->addItem("Ray casting");
+    topLayout->addWidget(engineSwitcher, 0, Qt::AlignLeft);
+
+    QCheckBox* softShadowToggle = new QCheckBox("Soft shadows", topPanel);
+    topLayout->addWidget(softShadowToggle, 0, Qt::AlignLeft);
+
+    QPushButton* saveButton = new QPushButton("Save", topPanel);
+    topLayout->addWidget(saveButton, 0, Qt::AlignLeft);
+    QPushButton* loadButton = new QPushButton("Load", topPanel);
+    topLayout->addWidget(loadButton, 0, Qt::AlignLeft);
+
     topLayout->addStretch();
 
     QPushButton* fpsIndicator = new QPushButton("FPS: N/A", topPanel);
-    fpsIndicator->setEnabled(false);
+    fpsIndicator->setFlat(true);
     topLayout->addWidget(fpsIndicator, 0, Qt::AlignRight);
     mainLayout->addWidget(topPanel);
 
@@ -50,5 +69,55 @@ QWidget* createMainWindow() {
             }
         });
 
+    QObject::connect(
+        engineSwitcher, QOverload<int>::of(&QComboBox::currentIndexChanged), [canvas](int index) {
+            if (index == 0) {
+                canvas->setVisibilityEngine(VisibilityEngine::AngularSweep);
+            } else {
+                canvas->setVisibilityEngine(VisibilityEngine::RayCasting);
+            }
+        });
+
+    QObject::connect(softShadowToggle, &QCheckBox::toggled, [canvas](bool checked) {
+        canvas->setSoftShadows(checked);
+    });
+
+    QObject::connect(saveButton, &QPushButton::clicked, [mainWin, canvas]() {
+        QString path = QFileDialog::getSaveFileName(
+            mainWin, "Save scene", "scene.rcs", "Raycaster scenes (*.rcs)");
+        std::string error;
+        if (!path.isEmpty() && !canvas->saveScene(path.toStdString(), &error)) {
+            QMessageBox::warning(mainWin, "Save scene", QString::fromStdString(error));
+        }
+    });
+
+    QObject::connect(loadButton, &QPushButton::clicked, [mainWin, canvas]() {
+        QString path = QFileDialog::getOpenFileName(
+            mainWin, "Load scene", QString(), "Raycaster scenes (*.rcs)");
+        std::string error;
+        if (!path.isEmpty() && !canvas->loadScene(path.toStdString(), &error)) {
+            QMessageBox::warning(mainWin, "Load scene", QString::fromStdString(error));
+        }
+    });
+
+    // The indicator shows the headline numbers, the tooltip has the full table and a click
+    // writes that table to a file.
+    QTimer* statsTimer = new QTimer(mainWin);
+    QObject::connect(statsTimer, &QTimer::timeout, [canvas, fpsIndicator]() {
+        const auto& stats = canvas->getFrameStats();
+        fpsIndicator->setText(QString::fromStdString(stats.summary()));
+        fpsIndicator->setToolTip(QString::fromStdString(stats.report()));
+    });
+    statsTimer->start(GlobalConfig::STATS_REFRESH_MS);
+
+    QObject::connect(fpsIndicator, &QPushButton::clicked, [mainWin, canvas]() {
+        QString path = QFileDialog::getSaveFileName(
+            mainWin, "Save frame statistics", "raycaster_stats.txt", "Text files (*.txt)");
+        if (!path.isEmpty() && !canvas->getFrameStats().dumpToFile(path.toStdString())) {
+            QMessageBox::warning(
+                mainWin, "Frame statistics", QString("Could not write %1").arg(path));
+        }
+    });
+
     return mainWin;
 }
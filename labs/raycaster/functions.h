@@ -1,22 +1,32 @@
 #ifndef FUNCTIONS_H
 #define FUNCTIONS_H
 
+#include "geometry.h"
 #include "ray.h"
+#include "utils.h"
 
-#include <QPoint>
-#include <QPointF>
 #include <cmath>
+#include <cstdint>
 #include <numbers>
 #include <optional>
 #include <utility>
 #include <vector>
 
-inline double calcDistance(const QPoint& a, const QPoint& b) {
-    return std::hypot(a.x() - b.x(), a.y() - b.y());
+inline double calcDistance(const GeometryNS::Point& a, const GeometryNS::Point& b) {
+    return std::hypot(a.x - b.x, a.y - b.y);
 }
 
-inline double calcDistance(const QPointF& a, const QPointF& b) {
-    return std::hypot(a.x() - b.x(), a.y() - b.y());
+inline double calcDistance(const GeometryNS::PointF& a, const GeometryNS::PointF& b) {
+    return std::hypot(a.x - b.x, a.y - b.y);
+}
+
+// End points closer than ENDPOINT_TOLERANCE, compared on squared integer distances.
+inline bool isSameEndpoint(const GeometryNS::Point& a, const GeometryNS::Point& b) {
+    constexpr double toleranceSquared =
+        GlobalConfig::ENDPOINT_TOLERANCE * GlobalConfig::ENDPOINT_TOLERANCE;
+    int64_t dx = static_cast<int64_t>(a.x) - b.x;
+    int64_t dy = static_cast<int64_t>(a.y) - b.y;
+    return static_cast<double>(dx * dx + dy * dy) < toleranceSquared;
 }
 
 inline double normalizeAngle(double angle) {
@@ -27,29 +37,127 @@ inline double normalizeAngle(double angle) {
 }
 
 inline std::optional<std::pair<double, double>> computeIntersectionParams(
-    const QPoint& segStart, const QPoint& segEnd, const QPoint& rayOrigin, double ray_dx,
-    double ray_dy) {
-    double seg_dx = segEnd.x() - segStart.x();
-    double seg_dy = segEnd.y() - segStart.y();
+    const GeometryNS::Point& segStart, const GeometryNS::Point& segEnd,
+    const GeometryNS::Point& rayOrigin, double ray_dx, double ray_dy) {
+    double seg_dx = segEnd.x - segStart.x;
+    double seg_dy = segEnd.y - segStart.y;
     double denominator = ray_dx * seg_dy - ray_dy * seg_dx;
     if (std::abs(denominator) < 1e-9) {
         return std::nullopt;
     }
-    double t = ((segStart.x() - rayOrigin.x()) * seg_dy - (segStart.y() - rayOrigin.y()) * seg_dx) /
+    double t = ((segStart.x - rayOrigin.x) * seg_dy - (segStart.y - rayOrigin.y) * seg_dx) /
                denominator;
-    double u = ((segStart.x() - rayOrigin.x()) * ray_dy - (segStart.y() - rayOrigin.y()) * ray_dx) /
+    double u = ((segStart.x - rayOrigin.x) * ray_dy - (segStart.y - rayOrigin.y) * ray_dx) /
                denominator;
     return std::make_pair(t, u);
 }
 
+// Whether both polygon edges at vertex lie on the same side of the line from the light through
+// it. Only then can light pass the vertex and the rays just beside it end somewhere else; a ray
+// that crosses the polygon boundary at vertex is stopped there on either side. Collinear and
+// degenerate edges count as silhouette, which only costs the two extra rays.
+inline bool isSilhouetteVertex(
+    const GeometryNS::Point& light, const GeometryNS::Point& prev, const GeometryNS::Point& vertex,
+    const GeometryNS::Point& next) {
+    auto cross = [](const GeometryNS::Point& a, const GeometryNS::Point& b) {
+        return static_cast<int64_t>(a.x) * b.y - static_cast<int64_t>(a.y) * b.x;
+    };
+    GeometryNS::Point toVertex = vertex - light;
+    int64_t prevSide = cross(toVertex, prev - vertex);
+    int64_t nextSide = cross(toVertex, next - vertex);
+    return !((prevSide > 0 && nextSide < 0) || (prevSide < 0 && nextSide > 0));
+}
+
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <ranges>
 
-inline void sortRaySegmentsByDirection(std::vector<RaySegmentNS::RaySegment>* rays) {
-    std::ranges::sort(
-        *rays, [](const RaySegmentNS::RaySegment& a, const RaySegmentNS::RaySegment& b) {
-            return a.getDirection() < b.getDirection();
+// A ray's position in the angular order plus its index in the unsorted array.
+struct RaySortKey {
+    uint64_t angle;
+    uint32_t index;
+};
+
+// The bit pattern of a non-negative double orders exactly like its value, so the pseudo-angle
+// becomes an integer key without losing precision; adding 0.0 turns -0.0 into +0.0.
+inline uint64_t angleKey(const GeometryNS::PointF& direction) {
+    return std::bit_cast<uint64_t>(GeometryNS::pseudoAngle(direction) + 0.0);
+}
+
+// Stable LSD radix sort on the angle, one byte per pass. Digits that are the same for every key
+// (the sign and most of the exponent, for angles in [0, 4)) are skipped, and short arrays go to
+// a comparison sort, which gives the same order since the index breaks ties there.
+inline void radixSortKeys(std::vector<RaySortKey>* keys, std::vector<RaySortKey>* spare) {
+    constexpr size_t RADIX_MIN_SIZE = 1024;
+    constexpr int DIGITS = 8;
+    constexpr int BUCKETS = 256;
+    if (keys->size() < RADIX_MIN_SIZE) {
+        std::ranges::sort(*keys, [](const RaySortKey& lhs, const RaySortKey& rhs) {
+            return lhs.angle != rhs.angle ? lhs.angle < rhs.angle : lhs.index < rhs.index;
         });
+        return;
+    }
+    std::array<std::array<uint32_t, BUCKETS>, DIGITS> counts{};
+    for (const auto& key : *keys) {
+        for (int digit = 0; digit < DIGITS; ++digit) {
+            ++counts[digit][(key.angle >> (8 * digit)) & 0xFF];
+        }
+    }
+    spare->resize(keys->size());
+    for (int digit = 0; digit < DIGITS; ++digit) {
+        auto& count = counts[digit];
+        uint64_t sample = ((*keys)[0].angle >> (8 * digit)) & 0xFF;
+        if (count[sample] == keys->size()) {
+            continue;
+        }
+        uint32_t offset = 0;
+        for (auto& bucket : count) {
+            uint32_t size = bucket;
+            bucket = offset;
+            offset += size;
+        }
+        for (const auto& key : *keys) {
+            (*spare)[count[(key.angle >> (8 * digit)) & 0xFF]++] = key;
+        }
+        keys->swap(*spare);
+    }
+}
+
+// Counter-clockwise from +x, like sorting by the normalized angle. Keys are radix-sorted and
+// the rays are then permuted once; keys, spare and sorted are working buffers that callers may
+// keep between frames.
+inline void sortRaySegmentsByDirection(
+    std::vector<RaySegmentNS::RaySegment>* rays, std::vector<RaySortKey>* keys,
+    std::vector<RaySortKey>* spare, std::vector<RaySegmentNS::RaySegment>* sorted) {
+    keys->clear();
+    for (size_t i = 0; i < rays->size(); ++i) {
+        keys->push_back({angleKey((*rays)[i].getDirectionVector()), static_cast<uint32_t>(i)});
+    }
+    radixSortKeys(keys, spare);
+    sorted->clear();
+    for (const auto& key : *keys) {
+        sorted->push_back((*rays)[key.index]);
+    }
+    rays->swap(*sorted);
+}
+
+// Same order for bare direction vectors: fills *keys sorted by angle.
+inline void sortDirections(
+    const std::vector<GeometryNS::PointF>& directions, std::vector<RaySortKey>* keys,
+    std::vector<RaySortKey>* spare) {
+    keys->clear();
+    for (size_t i = 0; i < directions.size(); ++i) {
+        keys->push_back({angleKey(directions[i]), static_cast<uint32_t>(i)});
+    }
+    radixSortKeys(keys, spare);
+}
+
+inline void sortRaySegmentsByDirection(std::vector<RaySegmentNS::RaySegment>* rays) {
+    std::vector<RaySortKey> keys;
+    std::vector<RaySortKey> spare;
+    std::vector<RaySegmentNS::RaySegment> sorted;
+    sortRaySegmentsByDirection(rays, &keys, &spare, &sorted);
 }
 
 #endif  // FUNCTIONS_H
@@ -0,0 +1,96 @@
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+#include <type_traits>
+
+namespace GeometryNS {
+
+// Plain scene coordinates shared by the core and its consumers. Point matches the integer
+// grid the editor works on, PointF carries exact intersection results.
+struct Point {
+    int x;
+    int y;
+
+    friend bool operator==(const Point&, const Point&) = default;
+};
+
+struct PointF {
+    double x;
+    double y;
+
+    friend bool operator==(const PointF&, const PointF&) = default;
+};
+
+struct Segment {
+    PointF a;
+    PointF b;
+};
+
+// Axis-aligned bounding box; both corners are inside it.
+struct Box {
+    Point min;
+    Point max;
+};
+
+static_assert(std::is_trivial_v<Point> && std::is_standard_layout_v<Point>);
+static_assert(std::is_trivial_v<PointF> && std::is_standard_layout_v<PointF>);
+static_assert(std::is_trivial_v<Segment> && std::is_standard_layout_v<Segment>);
+static_assert(std::is_trivial_v<Box> && std::is_standard_layout_v<Box>);
+
+inline Point operator+(const Point& a, const Point& b) {
+    return {a.x + b.x, a.y + b.y};
+}
+
+inline Point operator-(const Point& a, const Point& b) {
+    return {a.x - b.x, a.y - b.y};
+}
+
+inline PointF operator+(const PointF& a, const PointF& b) {
+    return {a.x + b.x, a.y + b.y};
+}
+
+inline PointF operator-(const PointF& a, const PointF& b) {
+    return {a.x - b.x, a.y - b.y};
+}
+
+inline PointF operator*(const PointF& a, double factor) {
+    return {a.x * factor, a.y * factor};
+}
+
+inline PointF toPointF(const Point& pt) {
+    return {static_cast<double>(pt.x), static_cast<double>(pt.y)};
+}
+
+// Rotation by a fixed angle as a 2x2 matrix. smallRotation() evaluates it at compile time by the
+// Taylor series, which is exact to double precision for angles below 1e-2.
+struct Rotation {
+    double cos;
+    double sin;
+};
+
+constexpr Rotation smallRotation(double angle) {
+    double sq = angle * angle;
+    return {1.0 - sq / 2.0 + sq * sq / 24.0, angle * (1.0 - sq / 6.0 + sq * sq / 120.0)};
+}
+
+inline PointF rotate(const PointF& v, const Rotation& rotation) {
+    return {v.x * rotation.cos - v.y * rotation.sin, v.x * rotation.sin + v.y * rotation.cos};
+}
+
+// Monotonic in the polar angle of v over [0, 2*pi), with values in [0, 4): the quadrant plus the
+// position along the diamond |x| + |y| = 1. Orders directions like atan2 without calling it.
+inline double pseudoAngle(const PointF& v) {
+    if (v.y >= 0) {
+        return v.x >= 0 ? v.y / (v.x + v.y) : 1.0 - v.x / (v.y - v.x);
+    }
+    return v.x < 0 ? 2.0 - v.y / (-v.x - v.y) : 3.0 + v.x / (v.x - v.y);
+}
+
+// Truncates towards zero, the way the editor has always snapped hits to pixels.
+inline Point truncated(const PointF& pt) {
+    return {static_cast<int>(pt.x), static_cast<int>(pt.y)};
+}
+
+}  // namespace GeometryNS
+
+#endif  // GEOMETRY_H
@@ -0,0 +1,407 @@
+#include "intersectkernel.h"
+
+#include "utils.h"
+
+#include <atomic>
+#include <cmath>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define RAYCASTER_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+// AVX-512 implies FMA; keep a * b - c * d unfused everywhere so that every variant rounds
+// exactly like the scalar loop. GCC gets the same from -ffp-contract=off in BUILD.
+#if defined(__clang__)
+#pragma clang fp contract(off)
+#endif
+
+namespace IntersectKernelNS {
+
+namespace {
+
+using CpuFeaturesNS::Isa;
+using RangeFn = EdgeHit (*)(const EdgeArrays&, const RayParams&, size_t, size_t);
+using ListFn = EdgeHit (*)(const EdgeArrays&, const RayParams&, const uint32_t*, size_t);
+
+struct KernelTable {
+    Isa isa;
+    RangeFn range;
+    ListFn list;
+};
+
+// Same formula as computeIntersectionParams; `pos` is the position inside the batch.
+inline void testEdge(
+    const EdgeArrays& e, const RayParams& r, size_t i, size_t pos, EdgeHit* best) {
+    double denominator = r.dx * e.dy[i] - r.dy * e.dx[i];
+    if (std::abs(denominator) < GlobalConfig::EPSILON) {
+        return;
+    }
+    double wx = e.startX[i] - r.ox;
+    double wy = e.startY[i] - r.oy;
+    double t = (wx * e.dy[i] - wy * e.dx[i]) / denominator;
+    double u = (wx * r.dy - wy * r.dx) / denominator;
+    if (t >= 0 && u >= 0 && u <= 1 && t < best->t) {
+        best->t = t;
+        best->edge = pos;
+    }
+}
+
+EdgeHit rangeScalar(const EdgeArrays& e, const RayParams& r, size_t from, size_t to) {
+    EdgeHit best;
+    for (size_t i = from; i < to; ++i) {
+        testEdge(e, r, i, i, &best);
+    }
+    return best;
+}
+
+EdgeHit listScalar(const EdgeArrays& e, const RayParams& r, const uint32_t* indices, size_t count) {
+    EdgeHit best;
+    for (size_t k = 0; k < count; ++k) {
+        testEdge(e, r, indices[k], k, &best);
+    }
+    if (best.edge != NO_EDGE) {
+        best.edge = indices[best.edge];
+    }
+    return best;
+}
+
+#ifdef RAYCASTER_X86_KERNELS
+
+// Folds per-lane minima into *best; lanes carry the batch position as a double.
+inline void reduceLanes(const double* laneT, const double* lanePos, int lanes, EdgeHit* best) {
+    for (int k = 0; k < lanes; ++k) {
+        if (lanePos[k] < 0) {
+            continue;
+        }
+        auto pos = static_cast<size_t>(lanePos[k]);
+        if (laneT[k] < best->t || (laneT[k] == best->t && pos < best->edge)) {
+            best->t = laneT[k];
+            best->edge = pos;
+        }
+    }
+}
+
+// --- SSE2: 2 edges per instruction, always available on x86-64 ---
+
+struct Sse2Hit {
+    __m128d t;
+    __m128d valid;
+};
+
+inline Sse2Hit sse2Intersect(
+    const RayParams& r, __m128d sx, __m128d sy, __m128d edx, __m128d edy) {
+    const __m128d signMask = _mm_set1_pd(-0.0);
+    __m128d rdx = _mm_set1_pd(r.dx);
+    __m128d rdy = _mm_set1_pd(r.dy);
+    __m128d denominator = _mm_sub_pd(_mm_mul_pd(rdx, edy), _mm_mul_pd(rdy, edx));
+    __m128d wx = _mm_sub_pd(sx, _mm_set1_pd(r.ox));
+    __m128d wy = _mm_sub_pd(sy, _mm_set1_pd(r.oy));
+    __m128d t = _mm_div_pd(_mm_sub_pd(_mm_mul_pd(wx, edy), _mm_mul_pd(wy, edx)), denominator);
+    __m128d u = _mm_div_pd(_mm_sub_pd(_mm_mul_pd(wx, rdy), _mm_mul_pd(wy, rdx)), denominator);
+    __m128d valid = _mm_cmpge_pd(
+        _mm_andnot_pd(signMask, denominator), _mm_set1_pd(GlobalConfig::EPSILON));
+    valid = _mm_and_pd(valid, _mm_cmpge_pd(t, _mm_setzero_pd()));
+    valid = _mm_and_pd(valid, _mm_cmpge_pd(u, _mm_setzero_pd()));
+    valid = _mm_and_pd(valid, _mm_cmple_pd(u, _mm_set1_pd(1.0)));
+    return {t, valid};
+}
+
+inline void sse2Keep(const Sse2Hit& hit, __m128d pos, __m128d* bestT, __m128d* bestPos) {
+    __m128d better = _mm_and_pd(hit.valid, _mm_cmplt_pd(hit.t, *bestT));
+    *bestT = _mm_or_pd(_mm_and_pd(better, hit.t), _mm_andnot_pd(better, *bestT));
+    *bestPos = _mm_or_pd(_mm_and_pd(better, pos), _mm_andnot_pd(better, *bestPos));
+}
+
+EdgeHit rangeSse2(const EdgeArrays& e, const RayParams& r, size_t from, size_t to) {
+    __m128d bestT = _mm_set1_pd(std::numeric_limits<double>::infinity());
+    __m128d bestPos = _mm_set1_pd(-1.0);
+    __m128d pos = _mm_set_pd(static_cast<double>(from + 1), static_cast<double>(from));
+    const __m128d step = _mm_set1_pd(2.0);
+    size_t i = from;
+    for (; i + 2 <= to; i += 2) {
+        Sse2Hit hit = sse2Intersect(
+            r, _mm_loadu_pd(e.startX + i), _mm_loadu_pd(e.startY + i), _mm_loadu_pd(e.dx + i),
+            _mm_loadu_pd(e.dy + i));
+        sse2Keep(hit, pos, &bestT, &bestPos);
+        pos = _mm_add_pd(pos, step);
+    }
+    alignas(16) double laneT[2];
+    alignas(16) double lanePos[2];
+    _mm_store_pd(laneT, bestT);
+    _mm_store_pd(lanePos, bestPos);
+    EdgeHit best;
+    reduceLanes(laneT, lanePos, 2, &best);
+    for (; i < to; ++i) {
+        testEdge(e, r, i, i, &best);
+    }
+    return best;
+}
+
+EdgeHit listSse2(const EdgeArrays& e, const RayParams& r, const uint32_t* indices, size_t count) {
+    __m128d bestT = _mm_set1_pd(std::numeric_limits<double>::infinity());
+    __m128d bestPos = _mm_set1_pd(-1.0);
+    __m128d pos = _mm_set_pd(1.0, 0.0);
+    const __m128d step = _mm_set1_pd(2.0);
+    size_t k = 0;
+    for (; k + 2 <= count; k += 2) {
+        uint32_t i0 = indices[k];
+        uint32_t i1 = indices[k + 1];
+        Sse2Hit hit = sse2Intersect(
+            r, _mm_set_pd(e.startX[i1], e.startX[i0]), _mm_set_pd(e.startY[i1], e.startY[i0]),
+            _mm_set_pd(e.dx[i1], e.dx[i0]), _mm_set_pd(e.dy[i1], e.dy[i0]));
+        sse2Keep(hit, pos, &bestT, &bestPos);
+        pos = _mm_add_pd(pos, step);
+    }
+    alignas(16) double laneT[2];
+    alignas(16) double lanePos[2];
+    _mm_store_pd(laneT, bestT);
+    _mm_store_pd(lanePos, bestPos);
+    EdgeHit best;
+    reduceLanes(laneT, lanePos, 2, &best);
+    for (; k < count; ++k) {
+        testEdge(e, r, indices[k], k, &best);
+    }
+    if (best.edge != NO_EDGE) {
+        best.edge = indices[best.edge];
+    }
+    return best;
+}
+
+// --- AVX2: 4 edges per instruction, gathers for the indexed variant ---
+
+struct Avx2Hit {
+    __m256d t;
+    __m256d valid;
+};
+
+__attribute__((target("avx2"))) inline Avx2Hit avx2Intersect(
+    const RayParams& r, __m256d sx, __m256d sy, __m256d edx, __m256d edy) {
+    const __m256d signMask = _mm256_set1_pd(-0.0);
+    __m256d rdx = _mm256_set1_pd(r.dx);
+    __m256d rdy = _mm256_set1_pd(r.dy);
+    __m256d denominator = _mm256_sub_pd(_mm256_mul_pd(rdx, edy), _mm256_mul_pd(rdy, edx));
+    __m256d wx = _mm256_sub_pd(sx, _mm256_set1_pd(r.ox));
+    __m256d wy = _mm256_sub_pd(sy, _mm256_set1_pd(r.oy));
+    __m256d t = _mm256_div_pd(
+        _mm256_sub_pd(_mm256_mul_pd(wx, edy), _mm256_mul_pd(wy, edx)), denominator);
+    __m256d u = _mm256_div_pd(
+        _mm256_sub_pd(_mm256_mul_pd(wx, rdy), _mm256_mul_pd(wy, rdx)), denominator);
+    __m256d valid = _mm256_cmp_pd(
+        _mm256_andnot_pd(signMask, denominator), _mm256_set1_pd(GlobalConfig::EPSILON),
+        _CMP_GE_OQ);
+    valid = _mm256_and_pd(valid, _mm256_cmp_pd(t, _mm256_setzero_pd(), _CMP_GE_OQ));
+    valid = _mm256_and_pd(valid, _mm256_cmp_pd(u, _mm256_setzero_pd(), _CMP_GE_OQ));
+    valid = _mm256_and_pd(valid, _mm256_cmp_pd(u, _mm256_set1_pd(1.0), _CMP_LE_OQ));
+    return {t, valid};
+}
+
+__attribute__((target("avx2"))) inline void avx2Keep(
+    const Avx2Hit& hit, __m256d pos, __m256d* bestT, __m256d* bestPos) {
+    __m256d better = _mm256_and_pd(hit.valid, _mm256_cmp_pd(hit.t, *bestT, _CMP_LT_OQ));
+    *bestT = _mm256_blendv_pd(*bestT, hit.t, better);
+    *bestPos = _mm256_blendv_pd(*bestPos, pos, better);
+}
+
+__attribute__((target("avx2"))) EdgeHit rangeAvx2(
+    const EdgeArrays& e, const RayParams& r, size_t from, size_t to) {
+    __m256d bestT = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+    __m256d bestPos = _mm256_set1_pd(-1.0);
+    auto base = static_cast<double>(from);
+    __m256d pos = _mm256_set_pd(base + 3, base + 2, base + 1, base);
+    const __m256d step = _mm256_set1_pd(4.0);
+    size_t i = from;
+    for (; i + 4 <= to; i += 4) {
+        Avx2Hit hit = avx2Intersect(
+            r, _mm256_loadu_pd(e.startX + i), _mm256_loadu_pd(e.startY + i),
+            _mm256_loadu_pd(e.dx + i), _mm256_loadu_pd(e.dy + i));
+        avx2Keep(hit, pos, &bestT, &bestPos);
+        pos = _mm256_add_pd(pos, step);
+    }
+    alignas(32) double laneT[4];
+    alignas(32) double lanePos[4];
+    _mm256_store_pd(laneT, bestT);
+    _mm256_store_pd(lanePos, bestPos);
+    EdgeHit best;
+    reduceLanes(laneT, lanePos, 4, &best);
+    for (; i < to; ++i) {
+        testEdge(e, r, i, i, &best);
+    }
+    return best;
+}
+
+__attribute__((target("avx2"))) EdgeHit listAvx2(
+    const EdgeArrays& e, const RayParams& r, const uint32_t* indices, size_t count) {
+    __m256d bestT = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+    __m256d bestPos = _mm256_set1_pd(-1.0);
+    __m256d pos = _mm256_set_pd(3.0, 2.0, 1.0, 0.0);
+    const __m256d step = _mm256_set1_pd(4.0);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+    size_t k = 0;
+    for (; k + 4 <= count; k += 4) {
+        __m128i idx = _mm_loadu_si128(reinterpret_cast<const __m128i*>(indices + k));
+        Avx2Hit hit = avx2Intersect(
+            r, _mm256_mask_i32gather_pd(zero, e.startX, idx, all, 8),
+            _mm256_mask_i32gather_pd(zero, e.startY, idx, all, 8),
+            _mm256_mask_i32gather_pd(zero, e.dx, idx, all, 8),
+            _mm256_mask_i32gather_pd(zero, e.dy, idx, all, 8));
+        avx2Keep(hit, pos, &bestT, &bestPos);
+        pos = _mm256_add_pd(pos, step);
+    }
+    alignas(32) double laneT[4];
+    alignas(32) double lanePos[4];
+    _mm256_store_pd(laneT, bestT);
+    _mm256_store_pd(lanePos, bestPos);
+    EdgeHit best;
+    reduceLanes(laneT, lanePos, 4, &best);
+    for (; k < count; ++k) {
+        testEdge(e, r, indices[k], k, &best);
+    }
+    if (best.edge != NO_EDGE) {
+        best.edge = indices[best.edge];
+    }
+    return best;
+}
+
+// --- AVX-512F: 8 edges per instruction with mask registers ---
+
+__attribute__((target("avx512f"))) inline __mmask8 avx512Intersect(
+    const RayParams& r, __m512d sx, __m512d sy, __m512d edx, __m512d edy, __m512d* tOut) {
+    __m512d rdx = _mm512_set1_pd(r.dx);
+    __m512d rdy = _mm512_set1_pd(r.dy);
+    __m512d denominator = _mm512_sub_pd(_mm512_mul_pd(rdx, edy), _mm512_mul_pd(rdy, edx));
+    __m512d wx = _mm512_sub_pd(sx, _mm512_set1_pd(r.ox));
+    __m512d wy = _mm512_sub_pd(sy, _mm512_set1_pd(r.oy));
+    __m512d t = _mm512_div_pd(
+        _mm512_sub_pd(_mm512_mul_pd(wx, edy), _mm512_mul_pd(wy, edx)), denominator);
+    __m512d u = _mm512_div_pd(
+        _mm512_sub_pd(_mm512_mul_pd(wx, rdy), _mm512_mul_pd(wy, rdx)), denominator);
+    __mmask8 valid = _mm512_cmp_pd_mask(
+        _mm512_abs_pd(denominator), _mm512_set1_pd(GlobalConfig::EPSILON), _CMP_GE_OQ);
+    valid &= _mm512_cmp_pd_mask(t, _mm512_setzero_pd(), _CMP_GE_OQ);
+    valid &= _mm512_cmp_pd_mask(u, _mm512_setzero_pd(), _CMP_GE_OQ);
+    valid &= _mm512_cmp_pd_mask(u, _mm512_set1_pd(1.0), _CMP_LE_OQ);
+    *tOut = t;
+    return valid;
+}
+
+__attribute__((target("avx512f"))) EdgeHit rangeAvx512(
+    const EdgeArrays& e, const RayParams& r, size_t from, size_t to) {
+    __m512d bestT = _mm512_set1_pd(std::numeric_limits<double>::infinity());
+    __m512d bestPos = _mm512_set1_pd(-1.0);
+    __m512d pos = _mm512_add_pd(
+        _mm512_set_pd(7.0, 6.0, 5.0, 4.0, 3.0, 2.0, 1.0, 0.0),
+        _mm512_set1_pd(static_cast<double>(from)));
+    const __m512d step = _mm512_set1_pd(8.0);
+    size_t i = from;
+    for (; i + 8 <= to; i += 8) {
+        __m512d t;
+        __mmask8 valid = avx512Intersect(
+            r, _mm512_loadu_pd(e.startX + i), _mm512_loadu_pd(e.startY + i),
+            _mm512_loadu_pd(e.dx + i), _mm512_loadu_pd(e.dy + i), &t);
+        __mmask8 better = valid & _mm512_cmp_pd_mask(t, bestT, _CMP_LT_OQ);
+        bestT = _mm512_mask_blend_pd(better, bestT, t);
+        bestPos = _mm512_mask_blend_pd(better, bestPos, pos);
+        pos = _mm512_add_pd(pos, step);
+    }
+    alignas(64) double laneT[8];
+    alignas(64) double lanePos[8];
+    _mm512_store_pd(laneT, bestT);
+    _mm512_store_pd(lanePos, bestPos);
+    EdgeHit best;
+    reduceLanes(laneT, lanePos, 8, &best);
+    for (; i < to; ++i) {
+        testEdge(e, r, i, i, &best);
+    }
+    return best;
+}
+
+__attribute__((target("avx512f"))) EdgeHit listAvx512(
+    const EdgeArrays& e, const RayParams& r, const uint32_t* indices, size_t count) {
+    __m512d bestT = _mm512_set1_pd(std::numeric_limits<double>::infinity());
+    __m512d bestPos = _mm512_set1_pd(-1.0);
+    __m512d pos = _mm512_set_pd(7.0, 6.0, 5.0, 4.0, 3.0, 2.0, 1.0, 0.0);
+    const __m512d step = _mm512_set1_pd(8.0);
+    const __m512d zero = _mm512_setzero_pd();
+    size_t k = 0;
+    for (; k + 8 <= count; k += 8) {
+        __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + k));
+        __m512d t;
+        __mmask8 valid = avx512Intersect(
+            r, _mm512_mask_i32gather_pd(zero, 0xFF, idx, e.startX, 8),
+            _mm512_mask_i32gather_pd(zero, 0xFF, idx, e.startY, 8),
+            _mm512_mask_i32gather_pd(zero, 0xFF, idx, e.dx, 8),
+            _mm512_mask_i32gather_pd(zero, 0xFF, idx, e.dy, 8), &t);
+        __mmask8 better = valid & _mm512_cmp_pd_mask(t, bestT, _CMP_LT_OQ);
+        bestT = _mm512_mask_blend_pd(better, bestT, t);
+        bestPos = _mm512_mask_blend_pd(better, bestPos, pos);
+        pos = _mm512_add_pd(pos, step);
+    }
+    alignas(64) double laneT[8];
+    alignas(64) double lanePos[8];
+    _mm512_store_pd(laneT, bestT);
+    _mm512_store_pd(lanePos, bestPos);
+    EdgeHit best;
+    reduceLanes(laneT, lanePos, 8, &best);
+    for (; k < count; ++k) {
+        testEdge(e, r, indices[k], k, &best);
+    }
+    if (best.edge != NO_EDGE) {
+        best.edge = indices[best.edge];
+    }
+    return best;
+}
+
+#endif  // RAYCASTER_X86_KERNELS
+
+const KernelTable SCALAR_TABLE{Isa::Scalar, rangeScalar, listScalar};
+#ifdef RAYCASTER_X86_KERNELS
+const KernelTable SSE2_TABLE{Isa::Sse2, rangeSse2, listSse2};
+const KernelTable AVX2_TABLE{Isa::Avx2, rangeAvx2, listAvx2};
+const KernelTable AVX512_TABLE{Isa::Avx512, rangeAvx512, listAvx512};
+#endif
+
+const KernelTable* tableFor(Isa isa) {
+#ifdef RAYCASTER_X86_KERNELS
+    switch (isa) {
+        case Isa::Avx512:
+            return &AVX512_TABLE;
+        case Isa::Avx2:
+            return &AVX2_TABLE;
+        case Isa::Sse2:
+            return &SSE2_TABLE;
+        case Isa::Scalar:
+            break;
+    }
+#endif
+    return &SCALAR_TABLE;
+}
+
+std::atomic<const KernelTable*> activeTable{tableFor(CpuFeaturesNS::bestSupportedIsa())};
+
+}  // namespace
+
+EdgeHit nearestInRange(const EdgeArrays& edges, const RayParams& ray, size_t from, size_t to) {
+    return activeTable.load(std::memory_order_relaxed)->range(edges, ray, from, to);
+}
+
+EdgeHit nearestInList(
+    const EdgeArrays& edges, const RayParams& ray, const uint32_t* indices, size_t count) {
+    return activeTable.load(std::memory_order_relaxed)->list(edges, ray, indices, count);
+}
+
+Isa activeIsa() {
+    return activeTable.load(std::memory_order_relaxed)->isa;
+}
+
+// Lets benchmarks compare the variants on one machine; refuses what the CPU cannot run.
+bool selectIsa(Isa isa) {
+    if (!CpuFeaturesNS::isSupported(isa)) {
+        return false;
+    }
+    activeTable.store(tableFor(isa), std::memory_order_relaxed);
+    return true;
+}
+
+}  // namespace IntersectKernelNS
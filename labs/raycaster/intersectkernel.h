@@ -0,0 +1,45 @@
+#ifndef INTERSECTKERNEL_H
+#define INTERSECTKERNEL_H
+
+#include "cpufeatures.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace IntersectKernelNS {
+
+constexpr size_t NO_EDGE = std::numeric_limits<size_t>::max();
+
+struct RayParams {
+    double ox;
+    double oy;
+    double dx;
+    double dy;
+};
+
+struct EdgeArrays {
+    const double* startX;
+    const double* startY;
+    const double* dx;
+    const double* dy;
+};
+
+struct EdgeHit {
+    double t = std::numeric_limits<double>::infinity();
+    size_t edge = NO_EDGE;
+};
+
+// Nearest hit of one ray against a batch of edges, several edges per instruction. The widest
+// instruction set the CPU supports is picked once at startup; all variants return the same
+// t and edge index as the scalar loop (ties go to the lower index).
+EdgeHit nearestInRange(const EdgeArrays& edges, const RayParams& ray, size_t from, size_t to);
+EdgeHit nearestInList(
+    const EdgeArrays& edges, const RayParams& ray, const uint32_t* indices, size_t count);
+
+CpuFeaturesNS::Isa activeIsa();
+bool selectIsa(CpuFeaturesNS::Isa isa);
+
+}  // namespace IntersectKernelNS
+
+#endif  // INTERSECTKERNEL_H
@@ -0,0 +1,126 @@
+#include "controller.h"
+#include "geometry.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <new>
+#include <numbers>
+#include <random>
+#include <vector>
+
+// Counts every heap allocation in the process, pool threads included. Every replaceable form
+// of new and delete goes through malloc and free, so allocation and release always match.
+namespace {
+
+std::atomic<uint64_t> heapAllocations{0};
+
+void* countedAllocate(size_t size) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+}  // namespace
+
+void* operator new(size_t size) {
+    return countedAllocate(size);
+}
+
+void* operator new[](size_t size) {
+    return countedAllocate(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t /*size*/) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t /*size*/) noexcept {
+    std::free(ptr);
+}
+
+namespace {
+
+constexpr uint32_t SCENE_SEED = 20'240'917U;
+constexpr int POLYGON_COUNT = 200;
+constexpr int VERTEX_COUNT = 12;
+constexpr int MAX_RADIUS = 12;
+constexpr int PATH_LENGTH = 64;
+
+// Star-shaped polygons with sorted random vertex angles, as in the benchmarks; enough rays to
+// go through the worker pool.
+RaycasterController makeScene() {
+    std::mt19937 rng(SCENE_SEED);
+    std::uniform_int_distribution<int> centerX(MAX_RADIUS, GlobalConfig::SCENE_WIDTH - MAX_RADIUS);
+    std::uniform_int_distribution<int> centerY(
+        MAX_RADIUS, GlobalConfig::SCENE_HEIGHT - MAX_RADIUS);
+    std::uniform_real_distribution<double> angle(0.0, 2.0 * std::numbers::pi);
+    std::uniform_real_distribution<double> radius(MAX_RADIUS / 3.0, MAX_RADIUS);
+    RaycasterController controller;
+    for (int p = 0; p < POLYGON_COUNT; ++p) {
+        int cx = centerX(rng);
+        int cy = centerY(rng);
+        std::vector<double> angles(VERTEX_COUNT);
+        for (auto& a : angles) {
+            a = angle(rng);
+        }
+        std::ranges::sort(angles);
+        std::vector<GeometryNS::Point> vertices;
+        for (double a : angles) {
+            double r = radius(rng);
+            vertices.push_back(
+                {cx + static_cast<int>(r * std::cos(a)), cy + static_cast<int>(r * std::sin(a))});
+        }
+        controller.addPolygon(vertices);
+    }
+    return controller;
+}
+
+// Walks the light along a fixed path once to size the scratch and the area, then walks it
+// again and returns the heap allocations of that second lap.
+uint64_t steadyStateAllocations(RaycasterController* controller) {
+    std::vector<GeometryNS::Point> path;
+    for (int i = 0; i < PATH_LENGTH; ++i) {
+        path.push_back(
+            {GlobalConfig::SCENE_WIDTH / 4 + i * 5, GlobalConfig::SCENE_HEIGHT / 3 + i * 3});
+    }
+    LightScratch scratch;
+    std::vector<GeometryNS::Point> area;
+    for (const auto& pt : path) {
+        controller->computeLightArea(pt, &scratch, &area);
+    }
+    uint64_t before = heapAllocations.load(std::memory_order_relaxed);
+    for (const auto& pt : path) {
+        controller->computeLightArea(pt, &scratch, &area);
+    }
+    return heapAllocations.load(std::memory_order_relaxed) - before;
+}
+
+TEST(LightAreaTest, RayCastingFramesDoNotAllocate) {
+    auto controller = makeScene();
+    controller.setVisibilityEngine(VisibilityEngine::RayCasting);
+    EXPECT_EQ(steadyStateAllocations(&controller), 0U);
+}
+
+TEST(LightAreaTest, AngularSweepFramesDoNotAllocate) {
+    auto controller = makeScene();
+    controller.setVisibilityEngine(VisibilityEngine::AngularSweep);
+    EXPECT_EQ(steadyStateAllocations(&controller), 0U);
+}
+
+}  // namespace
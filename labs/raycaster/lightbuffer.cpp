@@ -0,0 +1,245 @@
+#include "lightbuffer.h"
+
+#include "workerpool.h"
+
+#include <algorithm>
+#include <atomic>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define RAYCASTER_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+// As in the intersection kernels: no fused multiply-adds, so that every variant rounds like
+// the scalar loop; GCC gets -ffp-contract=off from BUILD.
+#if defined(__clang__)
+#pragma clang fp contract(off)
+#endif
+
+namespace LightBufferNS {
+
+namespace {
+
+using CpuFeaturesNS::Isa;
+
+constexpr size_t ROWS_PER_CHUNK = 8;
+// A whole polygon is scan-converted per task, so one layer per chunk already pays for it.
+constexpr size_t LAYERS_PER_CHUNK = 1;
+
+using ToneMapFn = void (*)(const float*, const float*, const float*, size_t, float, uint32_t*);
+
+// Channel value to byte, plus one half for rounding; the caller truncates.
+inline float mapChannel(float value, float exposure) {
+    float exposed = exposure * (value > 0.0F ? value : 0.0F);
+    float mapped = exposed / (1.0F + exposed);
+    mapped = mapped < 1.0F ? mapped : 1.0F;
+    return mapped * 255.0F + 0.5F;
+}
+
+inline uint32_t packPixel(float r, float g, float b) {
+    float a = std::max(std::max(r, g), b);
+    auto byte = [](float v) { return static_cast<uint32_t>(static_cast<int32_t>(v)); };
+    return byte(a) << 24 | byte(r) << 16 | byte(g) << 8 | byte(b);
+}
+
+void toneMapScalar(
+    const float* r, const float* g, const float* b, size_t count, float exposure,
+    uint32_t* out) {
+    for (size_t x = 0; x < count; ++x) {
+        out[x] = packPixel(
+            mapChannel(r[x], exposure), mapChannel(g[x], exposure), mapChannel(b[x], exposure));
+    }
+}
+
+#ifdef RAYCASTER_X86_KERNELS
+
+// --- SSE2: 4 pixels per instruction ---
+
+inline __m128 sse2MapChannel(__m128 value, __m128 exposure) {
+    const __m128 one = _mm_set1_ps(1.0F);
+    __m128 exposed = _mm_mul_ps(exposure, _mm_max_ps(value, _mm_setzero_ps()));
+    __m128 mapped = _mm_min_ps(_mm_div_ps(exposed, _mm_add_ps(one, exposed)), one);
+    return _mm_add_ps(_mm_mul_ps(mapped, _mm_set1_ps(255.0F)), _mm_set1_ps(0.5F));
+}
+
+void toneMapSse2(
+    const float* r, const float* g, const float* b, size_t count, float exposure,
+    uint32_t* out) {
+    __m128 e = _mm_set1_ps(exposure);
+    size_t x = 0;
+    for (; x + 4 <= count; x += 4) {
+        __m128 mr = sse2MapChannel(_mm_loadu_ps(r + x), e);
+        __m128 mg = sse2MapChannel(_mm_loadu_ps(g + x), e);
+        __m128 mb = sse2MapChannel(_mm_loadu_ps(b + x), e);
+        __m128i a = _mm_cvttps_epi32(_mm_max_ps(_mm_max_ps(mr, mg), mb));
+        __m128i pixel = _mm_or_si128(
+            _mm_or_si128(_mm_slli_epi32(a, 24), _mm_slli_epi32(_mm_cvttps_epi32(mr), 16)),
+            _mm_or_si128(_mm_slli_epi32(_mm_cvttps_epi32(mg), 8), _mm_cvttps_epi32(mb)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), pixel);
+    }
+    toneMapScalar(r + x, g + x, b + x, count - x, exposure, out + x);
+}
+
+// --- AVX2: 8 pixels per instruction ---
+
+__attribute__((target("avx2"))) inline __m256 avx2MapChannel(__m256 value, __m256 exposure) {
+    const __m256 one = _mm256_set1_ps(1.0F);
+    __m256 exposed = _mm256_mul_ps(exposure, _mm256_max_ps(value, _mm256_setzero_ps()));
+    __m256 mapped = _mm256_min_ps(_mm256_div_ps(exposed, _mm256_add_ps(one, exposed)), one);
+    return _mm256_add_ps(_mm256_mul_ps(mapped, _mm256_set1_ps(255.0F)), _mm256_set1_ps(0.5F));
+}
+
+__attribute__((target("avx2"))) void toneMapAvx2(
+    const float* r, const float* g, const float* b, size_t count, float exposure,
+    uint32_t* out) {
+    __m256 e = _mm256_set1_ps(exposure);
+    size_t x = 0;
+    for (; x + 8 <= count; x += 8) {
+        __m256 mr = avx2MapChannel(_mm256_loadu_ps(r + x), e);
+        __m256 mg = avx2MapChannel(_mm256_loadu_ps(g + x), e);
+        __m256 mb = avx2MapChannel(_mm256_loadu_ps(b + x), e);
+        __m256i a = _mm256_cvttps_epi32(_mm256_max_ps(_mm256_max_ps(mr, mg), mb));
+        __m256i pixel = _mm256_or_si256(
+            _mm256_or_si256(
+                _mm256_slli_epi32(a, 24), _mm256_slli_epi32(_mm256_cvttps_epi32(mr), 16)),
+            _mm256_or_si256(
+                _mm256_slli_epi32(_mm256_cvttps_epi32(mg), 8), _mm256_cvttps_epi32(mb)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x), pixel);
+    }
+    toneMapScalar(r + x, g + x, b + x, count - x, exposure, out + x);
+}
+
+#endif  // RAYCASTER_X86_KERNELS
+
+// The pass is bound by memory rather than arithmetic, so AVX-512 shares the AVX2 loop.
+ToneMapFn toneMapFor(Isa isa) {
+#ifdef RAYCASTER_X86_KERNELS
+    switch (isa) {
+        case Isa::Avx512:
+        case Isa::Avx2:
+            return toneMapAvx2;
+        case Isa::Sse2:
+            return toneMapSse2;
+        case Isa::Scalar:
+            break;
+    }
+#endif
+    return toneMapScalar;
+}
+
+std::atomic<Isa> toneMapIsa{CpuFeaturesNS::bestSupportedIsa()};
+
+}  // namespace
+
+Isa activeToneMapIsa() {
+    return toneMapIsa.load(std::memory_order_relaxed);
+}
+
+// Lets benchmarks compare the variants on one machine; refuses what the CPU cannot run.
+bool selectToneMapIsa(Isa isa) {
+    if (!CpuFeaturesNS::isSupported(isa)) {
+        return false;
+    }
+    toneMapIsa.store(isa, std::memory_order_relaxed);
+    return true;
+}
+
+LightBuffer::LightBuffer() : width(0), height(0) {
+}
+
+void LightBuffer::resize(int newWidth, int newHeight) {
+    width = std::max(newWidth, 0);
+    height = std::max(newHeight, 0);
+    for (auto& plane : planes) {
+        plane.assign(static_cast<size_t>(width) * height, 0.0F);
+    }
+}
+
+int LightBuffer::getWidth() const {
+    return width;
+}
+
+int LightBuffer::getHeight() const {
+    return height;
+}
+
+void LightBuffer::clear() {
+    for (auto& plane : planes) {
+        std::ranges::fill(plane, 0.0F);
+    }
+}
+
+void LightBuffer::accumulate(const std::vector<LightLayer>& layers) {
+    if (outlines.size() < layers.size()) {
+        outlines.resize(layers.size());
+    }
+    auto& pool = WorkerPoolNS::WorkerPool::shared();
+    auto outlineRange = [this, &layers](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            RasterNS::collectRowCrossings(*layers[i].area, 1, height, &outlines[i]);
+        }
+    };
+    pool.parallelFor(layers.size(), outlineRange, LAYERS_PER_CHUNK);
+    // Rows are independent, so each chunk owns its rows of the planes outright.
+    auto rowRange = [this, &layers](size_t begin, size_t end) {
+        accumulateRows(begin, end, layers);
+    };
+    pool.parallelFor(static_cast<size_t>(height), rowRange, ROWS_PER_CHUNK);
+}
+
+const std::vector<float>& LightBuffer::channel(size_t index) const {
+    return planes[index];
+}
+
+void LightBuffer::toneMap(float exposure, uint32_t* pixels, size_t stride) const {
+    ToneMapFn kernel = toneMapFor(activeToneMapIsa());
+    auto rowRange = [this, kernel, exposure, pixels, stride](size_t begin, size_t end) {
+        auto w = static_cast<size_t>(width);
+        for (size_t row = begin; row < end; ++row) {
+            kernel(
+                planes[0].data() + row * w, planes[1].data() + row * w,
+                planes[2].data() + row * w, w, exposure, pixels + row * stride);
+        }
+    };
+    WorkerPoolNS::WorkerPool::shared().parallelFor(
+        static_cast<size_t>(height), rowRange, ROWS_PER_CHUNK);
+}
+
+// Same scheme as the soft shadows: a covered run adds its light at its first pixel and takes
+// it back after its last one, and a prefix sum per channel spreads it over the row.
+void LightBuffer::accumulateRows(
+    size_t firstRow, size_t lastRow, const std::vector<LightLayer>& layers) {
+    thread_local std::vector<float> deltas;
+    auto w = static_cast<size_t>(width);
+    for (size_t row = firstRow; row < lastRow; ++row) {
+        deltas.assign(3 * (w + 1), 0.0F);
+        float* dr = deltas.data();
+        float* dg = dr + w + 1;
+        float* db = dg + w + 1;
+        for (size_t l = 0; l < layers.size(); ++l) {
+            const LightLayer& layer = layers[l];
+            float r = layer.color.r * layer.intensity;
+            float g = layer.color.g * layer.intensity;
+            float b = layer.color.b * layer.intensity;
+            RasterNS::forEachRun(outlines[l], row, width, [&](int from, int to) {
+                dr[from] += r;
+                dr[to] -= r;
+                dg[from] += g;
+                dg[to] -= g;
+                db[from] += b;
+                db[to] -= b;
+            });
+        }
+        for (size_t c = 0; c < 3; ++c) {
+            const float* delta = deltas.data() + c * (w + 1);
+            float* values = planes[c].data() + row * w;
+            float sum = 0.0F;
+            for (size_t x = 0; x < w; ++x) {
+                sum += delta[x];
+                values[x] += sum;
+            }
+        }
+    }
+}
+
+}  // namespace LightBufferNS
@@ -0,0 +1,66 @@
+#ifndef LIGHTBUFFER_H
+#define LIGHTBUFFER_H
+
+#include "cpufeatures.h"
+#include "geometry.h"
+#include "raster.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace LightBufferNS {
+
+// Linear light, 1 per channel being a white light at full intensity.
+struct Color {
+    float r = 1.0F;
+    float g = 1.0F;
+    float b = 1.0F;
+};
+
+// One light's visibility polygon and what it adds to every pixel it covers.
+struct LightLayer {
+    const std::vector<GeometryNS::Point>* area = nullptr;
+    Color color;
+    float intensity = 1.0F;
+};
+
+// Float RGB light per scene pixel, one plane per channel. Lights are added up rather than
+// painted over each other, so overlapping and colored lights mix, and only the tone map turns
+// the sum into 8-bit pixels. Both passes run on the shared worker pool, row by row, and cost
+// the same for a polygon of four vertices as for one of thousands. Not thread-safe.
+class LightBuffer {
+   public:
+    LightBuffer();
+
+    // Resizing drops the light added so far.
+    void resize(int width, int height);
+    int getWidth() const;
+    int getHeight() const;
+    void clear();
+    // Adds color * intensity to every pixel whose center lies inside a layer's area.
+    void accumulate(const std::vector<LightLayer>& layers);
+    // Light of one channel, row by row.
+    const std::vector<float>& channel(size_t index) const;
+    // Writes premultiplied ARGB32 (0xAARRGGBB) rows, stride pixels apart: each channel maps to
+    // e * x / (1 + e * x) and alpha to the largest channel, so a white light of intensity 1
+    // becomes white with opacity e / (1 + e). Uses activeToneMapIsa(); every variant writes the
+    // same bytes.
+    void toneMap(float exposure, uint32_t* pixels, size_t stride) const;
+
+   private:
+    void accumulateRows(size_t firstRow, size_t lastRow, const std::vector<LightLayer>& layers);
+
+    int width;
+    int height;
+    std::vector<float> planes[3];
+    std::vector<RasterNS::RowCrossings> outlines;
+};
+
+// Instruction set of the tone map, the widest one the CPU runs unless selected otherwise.
+CpuFeaturesNS::Isa activeToneMapIsa();
+bool selectToneMapIsa(CpuFeaturesNS::Isa isa);
+
+}  // namespace LightBufferNS
+
+#endif  // LIGHTBUFFER_H
@@ -0,0 +1,87 @@
+#include "lightcache.h"
+
+#include <functional>
+
+namespace LightCacheNS {
+
+namespace {
+
+// A list node and a hash node with its bucket slot, roughly, for a typical 64-bit library.
+constexpr size_t NODE_OVERHEAD_BYTES = 64;
+
+}  // namespace
+
+size_t CacheKeyHash::operator()(const CacheKey& key) const {
+    uint64_t position = static_cast<uint64_t>(static_cast<uint32_t>(key.lightPos.x)) << 32 |
+                        static_cast<uint32_t>(key.lightPos.y);
+    return std::hash<uint64_t>{}(position ^ (key.sceneGeneration * 0x9E3779B97F4A7C15ULL));
+}
+
+LightAreaCache::LightAreaCache(size_t budgetBytes) : budget(budgetBytes) {
+}
+
+bool LightAreaCache::lookup(const CacheKey& key, std::vector<GeometryNS::Point>* area) {
+    auto found = index.find(key);
+    if (found == index.end()) {
+        ++stats.misses;
+        return false;
+    }
+    ++stats.hits;
+    entries.splice(entries.begin(), entries, found->second);
+    area->assign(found->second->area.begin(), found->second->area.end());
+    return true;
+}
+
+void LightAreaCache::insert(const CacheKey& key, const std::vector<GeometryNS::Point>& area) {
+    if (auto found = index.find(key); found != index.end()) {
+        stats.bytes -= entryBytes(*found->second);
+        entries.erase(found->second);
+        index.erase(found);
+    }
+    Entry entry{key, area};
+    size_t bytes = entryBytes(entry);
+    if (bytes > budget) {
+        return;
+    }
+    entries.push_front(std::move(entry));
+    index.emplace(key, entries.begin());
+    stats.bytes += bytes;
+    evictToBudget();
+}
+
+void LightAreaCache::setBudget(size_t budgetBytes) {
+    budget = budgetBytes;
+    evictToBudget();
+}
+
+size_t LightAreaCache::getBudget() const {
+    return budget;
+}
+
+void LightAreaCache::clear() {
+    entries.clear();
+    index.clear();
+    stats.bytes = 0;
+}
+
+CacheStats LightAreaCache::getStats() const {
+    CacheStats current = stats;
+    current.entries = entries.size();
+    return current;
+}
+
+size_t LightAreaCache::entryBytes(const Entry& entry) {
+    return sizeof(Entry) + NODE_OVERHEAD_BYTES +
+           entry.area.capacity() * sizeof(GeometryNS::Point);
+}
+
+void LightAreaCache::evictToBudget() {
+    while (stats.bytes > budget && !entries.empty()) {
+        stats.bytes -= entryBytes(entries.back());
+        index.erase(entries.back().key);
+        entries.pop_back();
+        ++stats.evictions;
+    }
+}
+
+}  // namespace LightCacheNS
@@ -0,0 +1,69 @@
+#ifndef LIGHTCACHE_H
+#define LIGHTCACHE_H
+
+#include "geometry.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+namespace LightCacheNS {
+
+// A light area is fully determined by the integer light position and the scene it was computed
+// for; RaycasterController::getSceneGeneration() changes with every edit.
+struct CacheKey {
+    GeometryNS::Point lightPos;
+    uint64_t sceneGeneration;
+
+    bool operator==(const CacheKey& other) const = default;
+};
+
+struct CacheKeyHash {
+    size_t operator()(const CacheKey& key) const;
+};
+
+struct CacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t entries = 0;
+    size_t bytes = 0;
+};
+
+// Least recently used light areas within a memory budget. The byte count covers the stored
+// vertices and an estimate of the list and hash nodes around them. Not thread-safe.
+class LightAreaCache {
+   public:
+    explicit LightAreaCache(size_t budgetBytes);
+
+    // Copies a cached area into *area, reusing its storage, and marks the entry as just used.
+    bool lookup(const CacheKey& key, std::vector<GeometryNS::Point>* area);
+    // Areas bigger than the whole budget are not kept.
+    void insert(const CacheKey& key, const std::vector<GeometryNS::Point>& area);
+    void setBudget(size_t budgetBytes);
+    size_t getBudget() const;
+    void clear();
+    CacheStats getStats() const;
+
+   private:
+    struct Entry {
+        CacheKey key;
+        std::vector<GeometryNS::Point> area;
+    };
+    using EntryList = std::list<Entry>;
+
+    static size_t entryBytes(const Entry& entry);
+    void evictToBudget();
+
+    // Most recently used first.
+    EntryList entries;
+    std::unordered_map<CacheKey, EntryList::iterator, CacheKeyHash> index;
+    size_t budget;
+    CacheStats stats;
+};
+
+}  // namespace LightCacheNS
+
+#endif  // LIGHTCACHE_H
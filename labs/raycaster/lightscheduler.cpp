@@ -0,0 +1,135 @@
+#include "lightscheduler.h"
+
+#include "workerpool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace LightSchedulerNS {
+
+namespace {
+
+// Weight of the newest frame in the smoothed cost of a refresh.
+constexpr double COST_SMOOTHING = 0.25;
+
+}  // namespace
+
+LightScheduler::LightScheduler(double budgetMilliseconds)
+    : budget(budgetMilliseconds), refreshCost(0.0), frame(0), frameStats(nullptr) {
+}
+
+size_t LightScheduler::addLight(const RangedLight& light) {
+    slots.push_back({light, light, 0, false, 0, {}});
+    return slots.size() - 1;
+}
+
+void LightScheduler::setLight(size_t id, const RangedLight& light) {
+    slots[id].light = light;
+}
+
+const RangedLight& LightScheduler::getLight(size_t id) const {
+    return slots[id].light;
+}
+
+size_t LightScheduler::lightCount() const {
+    return slots.size();
+}
+
+void LightScheduler::clear() {
+    slots.clear();
+}
+
+const std::vector<GeometryNS::Point>& LightScheduler::getArea(size_t id) const {
+    return slots[id].area;
+}
+
+void LightScheduler::setBudget(double budgetMilliseconds) {
+    budget = budgetMilliseconds;
+}
+
+double LightScheduler::getBudget() const {
+    return budget;
+}
+
+void LightScheduler::setFrameStats(FrameStatsNS::FrameStats* stats) {
+    frameStats = stats;
+}
+
+// Pixels the light has moved (a change of radius or cone counts as the distance its rim moved)
+// plus one, times the frames since its last refresh.
+double LightScheduler::urgency(const Slot& slot) const {
+    if (!slot.computed) {
+        return std::numeric_limits<double>::infinity();
+    }
+    const auto& now = slot.light;
+    const auto& then = slot.computedFor;
+    double moved = std::hypot(now.pos.x - then.pos.x, now.pos.y - then.pos.y) +
+                   std::abs(now.radius - then.radius) +
+                   (std::abs(now.direction - then.direction) +
+                    std::abs(now.coneWidth - then.coneWidth)) *
+                       now.radius;
+    return (moved + 1.0) * static_cast<double>(frame - slot.refreshedFrame);
+}
+
+ScheduleStats LightScheduler::refresh(const RaycasterController& scene) {
+    auto started = std::chrono::steady_clock::now();
+    ++frame;
+    ScheduleStats stats;
+    stats.lights = slots.size();
+    uint64_t generation = scene.getSceneGeneration();
+    staleIds.clear();
+    for (size_t id = 0; id < slots.size(); ++id) {
+        const Slot& slot = slots[id];
+        if (!slot.computed || slot.sceneGeneration != generation ||
+            slot.light != slot.computedFor) {
+            staleIds.push_back(id);
+        }
+    }
+    stats.stale = staleIds.size();
+
+    // Before the first measurement every stale light is refreshed; that frame sets the cost.
+    size_t count = staleIds.size();
+    if (refreshCost > 0.0 && budget / refreshCost < static_cast<double>(count)) {
+        count = static_cast<size_t>(std::max(1.0, budget / refreshCost));
+    }
+    if (count < staleIds.size()) {
+        std::ranges::nth_element(
+            staleIds, staleIds.begin() + static_cast<std::ptrdiff_t>(count),
+            [this](size_t lhs, size_t rhs) { return urgency(slots[lhs]) > urgency(slots[rhs]); });
+    }
+    auto refreshRange = [this, &scene](size_t begin, size_t end) {
+        // One scratch per pool thread, kept for the life of the thread.
+        thread_local LightScratch scratch;
+        for (size_t i = begin; i < end; ++i) {
+            Slot& slot = slots[staleIds[i]];
+            scene.computeRangedLightArea(slot.light, &scratch, &slot.area);
+        }
+    };
+    WorkerPoolNS::WorkerPool::shared().parallelFor(count, refreshRange, 1);
+    for (size_t i = 0; i < count; ++i) {
+        Slot& slot = slots[staleIds[i]];
+        slot.computedFor = slot.light;
+        slot.sceneGeneration = generation;
+        slot.computed = true;
+        slot.refreshedFrame = frame;
+    }
+    stats.refreshed = count;
+    stats.skipped = staleIds.size() - count;
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - started;
+    stats.milliseconds = elapsed.count();
+    if (count > 0) {
+        double cost = stats.milliseconds / static_cast<double>(count);
+        refreshCost =
+            refreshCost == 0.0 ? cost : refreshCost + COST_SMOOTHING * (cost - refreshCost);
+    }
+    if (frameStats != nullptr) {
+        frameStats->addCount(FrameStatsNS::Counter::LightsRefreshed, stats.refreshed);
+        frameStats->addCount(FrameStatsNS::Counter::LightUpdatesSkipped, stats.skipped);
+    }
+    return stats;
+}
+
+}  // namespace LightSchedulerNS
@@ -0,0 +1,74 @@
+#ifndef LIGHTSCHEDULER_H
+#define LIGHTSCHEDULER_H
+
+#include "controller.h"
+#include "framestats.h"
+#include "geometry.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace LightSchedulerNS {
+
+// What one refresh did. Stale lights have moved or changed, or the scene has changed, since
+// their area was computed; the skipped ones keep their old area until a later frame.
+struct ScheduleStats {
+    size_t lights = 0;
+    size_t stale = 0;
+    size_t refreshed = 0;
+    size_t skipped = 0;
+    double milliseconds = 0.0;
+};
+
+// Keeps a light area per ranged light and, once per frame, recomputes as many stale ones as
+// the time budget allows. The most urgent go first: lights that have no area yet, then by how
+// far a light has moved since its area was computed times how many frames it has waited, so
+// moving lights win over ones that are only stale because the scene changed, but none of them
+// waits forever. Idle lights just keep their area. Refreshes run on the shared worker pool,
+// one light per task. Not thread-safe.
+class LightScheduler {
+   public:
+    explicit LightScheduler(double budgetMilliseconds);
+
+    // Returns the id of the new light; ids are indices and stay valid until clear().
+    size_t addLight(const RangedLight& light);
+    void setLight(size_t id, const RangedLight& light);
+    const RangedLight& getLight(size_t id) const;
+    size_t lightCount() const;
+    void clear();
+    // The area from the light's last refresh, which may be older than the light; empty until
+    // the first refresh.
+    const std::vector<GeometryNS::Point>& getArea(size_t id) const;
+    // At least one stale light is refreshed per call, so a tiny budget still makes progress.
+    ScheduleStats refresh(const RaycasterController& scene);
+    void setBudget(double budgetMilliseconds);
+    double getBudget() const;
+    // Refreshed and skipped lights are counted into stats; nullptr turns that off.
+    void setFrameStats(FrameStatsNS::FrameStats* stats);
+
+   private:
+    struct Slot {
+        RangedLight light;
+        // The light and scene the area was computed for.
+        RangedLight computedFor;
+        uint64_t sceneGeneration = 0;
+        bool computed = false;
+        uint64_t refreshedFrame = 0;
+        std::vector<GeometryNS::Point> area;
+    };
+
+    double urgency(const Slot& slot) const;
+
+    std::vector<Slot> slots;
+    std::vector<size_t> staleIds;
+    double budget;
+    // Smoothed wall time of one refresh, pool included; zero until the first one.
+    double refreshCost;
+    uint64_t frame;
+    FrameStatsNS::FrameStats* frameStats;
+};
+
+}  // namespace LightSchedulerNS
+
+#endif  // LIGHTSCHEDULER_H
@@ -0,0 +1,220 @@
+#include "lightworker.h"
+
+#include "utils.h"
+
+#include <utility>
+
+namespace LightWorkerNS {
+
+LightFrame& FrameBuffer::back() {
+    return frames[1 - frontIndex];
+}
+
+void FrameBuffer::swap() {
+    std::lock_guard lock(swapMutex);
+    frontIndex = 1 - frontIndex;
+}
+
+LightFrame FrameBuffer::front() const {
+    std::lock_guard lock(swapMutex);
+    return frames[frontIndex];
+}
+
+void FrameBuffer::copyFront(LightFrame* frame) const {
+    std::lock_guard lock(swapMutex);
+    *frame = frames[frontIndex];
+}
+
+LightWorker::LightWorker(std::function<void()> onFrameReady)
+    : frameReady(std::move(onFrameReady))
+    , pinnedScheduler(GlobalConfig::LIGHT_SCHEDULE_BUDGET_MS)
+    , cache(GlobalConfig::LIGHT_CACHE_BUDGET_BYTES)
+    , frameStats(nullptr)
+    , dropped(0)
+    , stopping(false) {
+    thread = std::thread(&LightWorker::run, this);
+}
+
+LightWorker::~LightWorker() {
+    {
+        std::lock_guard lock(requestMutex);
+        stopping = true;
+    }
+    requestPosted.notify_one();
+    thread.join();
+}
+
+void LightWorker::request(
+    Snapshot scene, const GeometryNS::Point& lightPos, std::vector<PointLight> pinnedLights) {
+    {
+        std::lock_guard lock(requestMutex);
+        if (pending.has_value()) {
+            ++dropped;
+        }
+        pending = Request{std::move(scene), lightPos, {}, std::move(pinnedLights)};
+    }
+    requestPosted.notify_one();
+}
+
+void LightWorker::request(Snapshot scene, std::vector<SoftShadowNS::AreaLight> lights) {
+    GeometryNS::Point lightPos = lights.empty() ? GeometryNS::Point{} : lights.back().center;
+    {
+        std::lock_guard lock(requestMutex);
+        if (pending.has_value()) {
+            ++dropped;
+        }
+        pending = Request{std::move(scene), lightPos, std::move(lights), {}};
+    }
+    requestPosted.notify_one();
+}
+
+LightFrame LightWorker::latestFrame() const {
+    return buffer.front();
+}
+
+void LightWorker::latestFrame(LightFrame* frame) const {
+    buffer.copyFront(frame);
+}
+
+size_t LightWorker::droppedRequests() const {
+    std::lock_guard lock(requestMutex);
+    return dropped;
+}
+
+void LightWorker::setFrameStats(FrameStatsNS::FrameStats* stats) {
+    frameStats.store(stats);
+}
+
+void LightWorker::setCacheBudget(size_t budgetBytes) {
+    std::lock_guard lock(cacheMutex);
+    cache.setBudget(budgetBytes);
+}
+
+LightCacheNS::CacheStats LightWorker::cacheStats() const {
+    std::lock_guard lock(cacheMutex);
+    return cache.getStats();
+}
+
+void LightWorker::run() {
+    while (true) {
+        Request current;
+        {
+            std::unique_lock lock(requestMutex);
+            requestPosted.wait(lock, [this] { return stopping || pending.has_value(); });
+            if (stopping) {
+                return;
+            }
+            current = std::move(*pending);
+            pending.reset();
+        }
+        // Only this thread touches the back frame and the scratch, so both are filled without
+        // holding a lock and keep their storage from frame to frame.
+        LightFrame& frame = buffer.back();
+        frame.lightPos = current.lightPos;
+        frame.soft = !current.areaLights.empty();
+        if (frame.soft) {
+            softShadows.render(current.scene, current.areaLights, &frame.intensity);
+            frame.samplesPerLight = softShadows.lastSampleCount();
+            if (auto* stats = frameStats.load(); stats != nullptr) {
+                stats->addCount(
+                    FrameStatsNS::Counter::LightSamples,
+                    frame.samplesPerLight * current.areaLights.size());
+            }
+            frame.valid = true;
+            buffer.swap();
+            if (frameReady) {
+                frameReady();
+            }
+            continue;
+        }
+        findArea(current.scene, current.lightPos, &frame.area);
+        bool deferred = refreshPinnedLights(current);
+        composite(current, &frame);
+        frame.valid = true;
+        buffer.swap();
+        if (frameReady) {
+            frameReady();
+        }
+        // Lights left over budget catch up on the following frames without waiting for the GUI;
+        // a newer request takes over and carries them along.
+        if (deferred) {
+            std::lock_guard lock(requestMutex);
+            if (!pending.has_value()) {
+                pending = std::move(current);
+            }
+        }
+    }
+}
+
+void LightWorker::findArea(
+    const Snapshot& scene, const GeometryNS::Point& lightPos,
+    std::vector<GeometryNS::Point>* area) {
+    LightCacheNS::CacheKey key{lightPos, scene->getSceneGeneration()};
+    bool cached = false;
+    {
+        std::lock_guard lock(cacheMutex);
+        cached = cache.lookup(key, area);
+    }
+    if (!cached) {
+        scene->computeLightArea(lightPos, &scratch, area);
+        std::lock_guard lock(cacheMutex);
+        cache.insert(key, *area);
+    }
+    if (auto* stats = frameStats.load(); stats != nullptr) {
+        auto counter = cached ? FrameStatsNS::Counter::CacheHits
+                              : FrameStatsNS::Counter::CacheMisses;
+        stats->addCount(counter, 1);
+    }
+}
+
+// Pinning or unpinning a light renumbers the lights, so the scheduler then starts over; an
+// unchanged light keeps its area and costs nothing. Returns whether some stale lights were put
+// off to a later frame.
+bool LightWorker::refreshPinnedLights(const Request& current) {
+    const auto& lights = current.pinnedLights;
+    if (pinnedScheduler.lightCount() != lights.size()) {
+        pinnedScheduler.clear();
+        for (const auto& light : lights) {
+            pinnedScheduler.addLight({light.pos, light.range});
+        }
+    } else {
+        for (size_t i = 0; i < lights.size(); ++i) {
+            pinnedScheduler.setLight(i, {lights[i].pos, lights[i].range});
+        }
+    }
+    if (lights.empty()) {
+        return false;
+    }
+    pinnedScheduler.setFrameStats(frameStats.load());
+    return pinnedScheduler.refresh(*current.scene).skipped > 0;
+}
+
+// The light that follows the mouse is white at intensity 1, which the exposure tones to the
+// opacity the light area used to be filled with.
+void LightWorker::composite(const Request& current, LightFrame* frame) {
+    {
+        FrameStatsNS::ScopedStageTimer compositeTimer(
+            frameStats.load(), FrameStatsNS::Stage::Composite);
+        layers.clear();
+        layers.push_back({&frame->area, {}, 1.0F});
+        for (size_t i = 0; i < current.pinnedLights.size(); ++i) {
+            const PointLight& light = current.pinnedLights[i];
+            layers.push_back({&pinnedScheduler.getArea(i), light.color, light.intensity});
+        }
+        if (lightBuffer.getWidth() != GlobalConfig::SCENE_WIDTH ||
+            lightBuffer.getHeight() != GlobalConfig::SCENE_HEIGHT) {
+            lightBuffer.resize(GlobalConfig::SCENE_WIDTH, GlobalConfig::SCENE_HEIGHT);
+        } else {
+            lightBuffer.clear();
+        }
+        lightBuffer.accumulate(layers);
+    }
+    FrameStatsNS::ScopedStageTimer toneMapTimer(frameStats.load(), FrameStatsNS::Stage::ToneMap);
+    frame->width = lightBuffer.getWidth();
+    frame->height = lightBuffer.getHeight();
+    frame->pixels.resize(static_cast<size_t>(frame->width) * frame->height);
+    lightBuffer.toneMap(
+        GlobalConfig::LIGHT_EXPOSURE, frame->pixels.data(), static_cast<size_t>(frame->width));
+}
+
+}  // namespace LightWorkerNS
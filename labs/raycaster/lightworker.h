@@ -0,0 +1,132 @@
+#ifndef LIGHTWORKER_H
+#define LIGHTWORKER_H
+
+#include "controller.h"
+#include "framestats.h"
+#include "geometry.h"
+#include "lightbuffer.h"
+#include "lightcache.h"
+#include "lightscheduler.h"
+#include "softshadow.h"
+#include "utils.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace LightWorkerNS {
+
+// A light pinned to the scene next to the one that follows the mouse; it reaches range pixels.
+struct PointLight {
+    GeometryNS::Point pos;
+    LightBufferNS::Color color;
+    float intensity = 1.0F;
+    int range = GlobalConfig::PINNED_LIGHT_RANGE;
+};
+
+// Light computed for one light position, as drawn by the canvas: the area of that light and
+// the toned pixels of it and the pinned lights, premultiplied ARGB32 at scene resolution. A
+// frame of area lights carries their intensity buffer instead.
+struct LightFrame {
+    GeometryNS::Point lightPos{};
+    std::vector<GeometryNS::Point> area;
+    int width = 0;
+    int height = 0;
+    std::vector<uint32_t> pixels;
+    bool soft = false;
+    SoftShadowNS::IntensityBuffer intensity;
+    size_t samplesPerLight = 0;
+    bool valid = false;
+};
+
+// Front/back pair of frames: the worker fills the back one and swaps, readers only ever see a
+// finished frame. The lock is held for the swap and the copy-out, never for the computation.
+class FrameBuffer {
+   public:
+    LightFrame& back();
+    void swap();
+    LightFrame front() const;
+    void copyFront(LightFrame* frame) const;
+
+   private:
+    mutable std::mutex swapMutex;
+    LightFrame frames[2];
+    size_t frontIndex = 0;
+};
+
+// Computes light areas on a dedicated thread and composites them into pixels there as well.
+// Only the newest request is kept: a request that arrives while another one is waiting
+// replaces it, so a fast mouse never builds up a backlog. The scene is passed as an immutable
+// snapshot so that the GUI can keep editing its own copy. Areas are remembered per (light
+// position, scene generation), so hovering back over the same spot of an unchanged scene is a
+// copy instead of a computation. Pinned lights are ranged lights kept by a LightScheduler: they
+// are only recomputed when they or the scene change, and then only as many per frame as
+// GlobalConfig::LIGHT_SCHEDULE_BUDGET_MS allows; the worker then keeps rendering frames on its
+// own until the rest have caught up. Soft shadows of area lights are rendered on the same thread
+// and are not cached.
+class LightWorker {
+   public:
+    using Snapshot = std::shared_ptr<const RaycasterController>;
+
+    explicit LightWorker(std::function<void()> onFrameReady);
+    ~LightWorker();
+    LightWorker(const LightWorker&) = delete;
+    LightWorker& operator=(const LightWorker&) = delete;
+
+    // The light at lightPos is white; pinned lights add their own color on top.
+    void request(
+        Snapshot scene, const GeometryNS::Point& lightPos,
+        std::vector<PointLight> pinnedLights = {});
+    void request(Snapshot scene, std::vector<SoftShadowNS::AreaLight> lights);
+    LightFrame latestFrame() const;
+    // Copies into *frame, reusing its storage; lets a painter keep one frame around.
+    void latestFrame(LightFrame* frame) const;
+    size_t droppedRequests() const;
+    // Cache hits and misses and the pinned lights refreshed and skipped also go to stats as they
+    // happen; nullptr turns that off.
+    void setFrameStats(FrameStatsNS::FrameStats* stats);
+    void setCacheBudget(size_t budgetBytes);
+    LightCacheNS::CacheStats cacheStats() const;
+
+   private:
+    struct Request {
+        Snapshot scene;
+        GeometryNS::Point lightPos;
+        std::vector<SoftShadowNS::AreaLight> areaLights;
+        std::vector<PointLight> pinnedLights;
+    };
+
+    void run();
+    void findArea(
+        const Snapshot& scene, const GeometryNS::Point& lightPos,
+        std::vector<GeometryNS::Point>* area);
+    bool refreshPinnedLights(const Request& current);
+    void composite(const Request& current, LightFrame* frame);
+
+    std::function<void()> frameReady;
+    FrameBuffer buffer;
+    LightScratch scratch;
+    SoftShadowNS::SoftShadowRenderer softShadows;
+    LightBufferNS::LightBuffer lightBuffer;
+    LightSchedulerNS::LightScheduler pinnedScheduler;
+    std::vector<LightBufferNS::LightLayer> layers;
+    mutable std::mutex cacheMutex;
+    LightCacheNS::LightAreaCache cache;
+    std::atomic<FrameStatsNS::FrameStats*> frameStats;
+    mutable std::mutex requestMutex;
+    std::condition_variable requestPosted;
+    std::optional<Request> pending;
+    size_t dropped;
+    bool stopping;
+    std::thread thread;
+};
+
+}  // namespace LightWorkerNS
+
+#endif  // LIGHTWORKER_H
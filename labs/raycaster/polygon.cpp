@@ -1,29 +1,267 @@
 #include "polygon.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <limits>
 
 namespace PolygonShapeNS {
 
+namespace {
+
+// The simplicity check is quadratic; bigger polygons are reported as not simple.
+constexpr size_t SIMPLE_CHECK_LIMIT = 256;
+// Below this many vertices the binary searches of the convex queries save nothing over a scan.
+constexpr size_t CONVEX_QUERY_MIN = 16;
+
+// Twice the signed area of the triangle abc, exact for editor coordinates.
+int64_t orient(const GeometryNS::Point& a, const GeometryNS::Point& b, const GeometryNS::Point& c) {
+    return (static_cast<int64_t>(b.x) - a.x) * (static_cast<int64_t>(c.y) - a.y) -
+           (static_cast<int64_t>(b.y) - a.y) * (static_cast<int64_t>(c.x) - a.x);
+}
+
+// For pt on the line through a and b: whether it lies on the segment.
+bool withinSegment(
+    const GeometryNS::Point& pt, const GeometryNS::Point& a, const GeometryNS::Point& b) {
+    return pt.x >= std::min(a.x, b.x) && pt.x <= std::max(a.x, b.x) &&
+           pt.y >= std::min(a.y, b.y) && pt.y <= std::max(a.y, b.y);
+}
+
+int sign(int64_t value) {
+    return (value > 0) - (value < 0);
+}
+
+// Whether the direction of v lies in [pi, 2pi).
+bool inLowerHalf(const GeometryNS::Point& v) {
+    return v.y < 0 || (v.y == 0 && v.x < 0);
+}
+
+// The first index in [lo, hi] where pred holds, for pred false up to some index and true from
+// there on; pred(hi) must hold.
+template <class Pred>
+size_t firstWhere(size_t lo, size_t hi, Pred pred) {
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (pred(mid)) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return lo;
+}
+
+bool segmentsTouch(
+    const GeometryNS::Point& a, const GeometryNS::Point& b, const GeometryNS::Point& c,
+    const GeometryNS::Point& d) {
+    int abc = sign(orient(a, b, c));
+    int abd = sign(orient(a, b, d));
+    int cda = sign(orient(c, d, a));
+    int cdb = sign(orient(c, d, b));
+    if (abc * abd < 0 && cda * cdb < 0) {
+        return true;
+    }
+    return (abc == 0 && withinSegment(c, a, b)) || (abd == 0 && withinSegment(d, a, b)) ||
+           (cda == 0 && withinSegment(a, c, d)) || (cdb == 0 && withinSegment(b, c, d));
+}
+
+}  // namespace
+
 PolygonShape::PolygonShape() = default;
 
-PolygonShape::PolygonShape(const std::vector<QPoint>& points) : vertices(points) {
+PolygonShape::PolygonShape(const std::vector<GeometryNS::Point>& points) : vertices(points) {
+    updateBounds();
 }
 
-void PolygonShape::addVertex(const QPoint& pt) {
+void PolygonShape::addVertex(const GeometryNS::Point& pt) {
     vertices.push_back(pt);
+    convexity = 0;
+    if (vertices.size() == 1) {
+        bounds = {pt, pt};
+        return;
+    }
+    bounds.min = {std::min(bounds.min.x, pt.x), std::min(bounds.min.y, pt.y)};
+    bounds.max = {std::max(bounds.max.x, pt.x), std::max(bounds.max.y, pt.y)};
 }
 
-void PolygonShape::updateLastVertex(const QPoint& pt) {
+// The moved vertex may have been the one that defined the box, so it is recomputed.
+void PolygonShape::updateLastVertex(const GeometryNS::Point& pt) {
     if (!vertices.empty()) {
         vertices.back() = pt;
+        updateBounds();
+        convexity = 0;
     }
 }
 
 void PolygonShape::clear() {
     vertices.clear();
+    bounds = {};
+    convexity = 0;
+}
+
+void PolygonShape::updateBounds() {
+    if (vertices.empty()) {
+        bounds = {};
+        return;
+    }
+    bounds = {vertices.front(), vertices.front()};
+    for (const auto& pt : vertices) {
+        bounds.min = {std::min(bounds.min.x, pt.x), std::min(bounds.min.y, pt.y)};
+        bounds.max = {std::max(bounds.max.x, pt.x), std::max(bounds.max.y, pt.y)};
+    }
+}
+
+const GeometryNS::Box& PolygonShape::getBounds() const {
+    return bounds;
+}
+
+int PolygonShape::simpleOrientation() const {
+    if (convexity != 0) {
+        return convexity;
+    }
+    size_t count = vertices.size();
+    if (count < 3 || count > SIMPLE_CHECK_LIMIT) {
+        return 0;
+    }
+    auto at = [this, count](size_t i) -> const GeometryNS::Point& {
+        return vertices[i % count];
+    };
+    int64_t doubleArea = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (at(i) == at(i + 1)) {
+            return 0;
+        }
+        // Neighbouring edges may only share their common vertex, not fold back over each other.
+        const auto& vertex = at(i + 1);
+        auto toPrev = at(i) - vertex;
+        auto toNext = at(i + 2) - vertex;
+        if (orient(at(i), vertex, at(i + 2)) == 0 &&
+            static_cast<int64_t>(toPrev.x) * toNext.x + static_cast<int64_t>(toPrev.y) * toNext.y >
+                0) {
+            return 0;
+        }
+        for (size_t j = i + 2; j < count; ++j) {
+            if (i == 0 && j == count - 1) {
+                continue;
+            }
+            if (segmentsTouch(at(i), at(i + 1), at(j), at(j + 1))) {
+                return 0;
+            }
+        }
+        doubleArea += static_cast<int64_t>(at(i).x) * at(i + 1).y -
+                      static_cast<int64_t>(at(i + 1).x) * at(i).y;
+    }
+    return sign(doubleArea);
+}
+
+// Even-odd crossing test on exact integers; points on an edge are reported separately.
+PointLocation PolygonShape::locatePoint(const GeometryNS::Point& pt) const {
+    if (vertices.empty() || pt.x < bounds.min.x || pt.x > bounds.max.x ||
+        pt.y < bounds.min.y || pt.y > bounds.max.y) {
+        return PointLocation::Outside;
+    }
+    bool inside = false;
+    size_t count = vertices.size();
+    for (size_t i = 0; i < count; ++i) {
+        const auto& a = vertices[i];
+        const auto& b = vertices[(i + 1) % count];
+        int64_t side = orient(a, b, pt);
+        if (side == 0 && withinSegment(pt, a, b)) {
+            return PointLocation::Boundary;
+        }
+        if ((a.y > pt.y) != (b.y > pt.y) && (side > 0) == (b.y > a.y)) {
+            inside = !inside;
+        }
+    }
+    return inside ? PointLocation::Inside : PointLocation::Outside;
+}
+
+// Every turn must go the same way, and the edge directions must pass the positive x axis exactly
+// once: more would mean the boundary winds around several times.
+void PolygonShape::updateConvexity() {
+    convexity = 0;
+    size_t count = vertices.size();
+    if (count < 3) {
+        return;
+    }
+    int turn = 0;
+    size_t wraps = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const auto& a = vertices[i];
+        const auto& b = vertices[(i + 1) % count];
+        const auto& c = vertices[(i + 2) % count];
+        int side = sign(orient(a, b, c));
+        if (side == 0 || (turn != 0 && side != turn)) {
+            return;
+        }
+        turn = side;
+        bool lowerBefore = inLowerHalf(b - a);
+        bool lowerAfter = inLowerHalf(c - b);
+        if (turn > 0 ? lowerBefore && !lowerAfter : !lowerBefore && lowerAfter) {
+            ++wraps;
+        }
+    }
+    if (wraps == 1) {
+        convexity = turn;
+    }
+}
+
+bool PolygonShape::isConvex() const {
+    return convexity != 0;
 }
 
-const std::vector<QPoint>& PolygonShape::getVertices() const {
+// Seen from outside, the boundary of a convex polygon splits into a chain facing pt and one
+// facing away; each tangent vertex is where the side of pt against the edges flips (or an edge
+// that points straight at pt). Starting from a vertex where the line of sight cuts into the
+// polygon, the line meets the boundary once more on the other chain, and the side of pt against
+// that line, then against the edges of each half, changes only once, so all three are found by
+// binary search.
+std::optional<std::pair<size_t, size_t>> PolygonShape::facingChain(
+    const GeometryNS::Point& pt) const {
+    size_t count = vertices.size();
+    if (convexity == 0 || count < CONVEX_QUERY_MIN ||
+        (pt.x >= bounds.min.x && pt.x <= bounds.max.x && pt.y >= bounds.min.y &&
+         pt.y <= bounds.max.y)) {
+        return std::nullopt;
+    }
+    // At most four vertices are on the silhouette, so one of the first five is not.
+    size_t base = 0;
+    while (isSilhouetteVertex(
+        pt, vertices[(base + count - 1) % count], vertices[base], vertices[base + 1])) {
+        ++base;
+    }
+    auto at = [this, base, count](size_t i) -> const GeometryNS::Point& {
+        return vertices[(base + i) % count];
+    };
+    auto edgeSide = [&pt, &at](size_t i) {
+        return sign(orient(pt, at(i), at(i + 1)));
+    };
+    int baseSide = edgeSide(0);
+    size_t beyond = firstWhere(1, count - 1, [&pt, &at, baseSide](size_t i) {
+        return sign(orient(pt, at(0), at(i))) != baseSide;
+    });
+    size_t crossing = beyond - 1;
+    if (edgeSide(crossing) != -baseSide) {
+        return std::nullopt;
+    }
+    size_t turnA = firstWhere(1, crossing, [&edgeSide, baseSide](size_t i) {
+        return edgeSide(i) != baseSide;
+    });
+    size_t turnB = firstWhere(crossing + 1, count - 1, [&edgeSide, baseSide](size_t i) {
+        return edgeSide(i) != -baseSide;
+    });
+    // An edge faces pt when pt is on its outer side, which is the right for a counter-clockwise
+    // polygon.
+    size_t first = turnA;
+    size_t last = turnB + (edgeSide(turnB) == 0 ? 1 : 0);
+    if (baseSide * convexity < 0) {
+        first = turnB;
+        last = turnA + (edgeSide(turnA) == 0 ? 1 : 0);
+    }
+    return std::make_pair((base + first) % count, (base + last) % count);
+}
+
+const std::vector<GeometryNS::Point>& PolygonShape::getVertices() const {
     return vertices;
 }
 
@@ -31,42 +269,63 @@ bool PolygonShape::isValid() const {
     return vertices.size() >= 3;
 }
 
-std::vector<QPoint> PolygonShape::closedVertices() const {
-    std::vector<QPoint> pts = vertices;
+std::vector<GeometryNS::Point> PolygonShape::closedVertices() const {
+    std::vector<GeometryNS::Point> pts = vertices;
     if (!pts.empty()) {
         pts.push_back(pts.front());
     }
     return pts;
 }
 
-std::optional<QPoint> PolygonShape::findRayIntersection(const RaySegmentNS::RaySegment& ray) const {
-    std::optional<QPoint> bestIntersection;
+// From outside a convex polygon a ray can only enter through the facing chain, on the edge
+// whose ends lie on both sides of it; the chain is ordered by angle from the ray's start, so that
+// edge is found by binary search. Its neighbours are tested as well, so rays through a vertex get
+// the same answer as from the full scan.
+std::optional<GeometryNS::Point> PolygonShape::findRayIntersection(
+    const RaySegmentNS::RaySegment& ray) const {
+    size_t count = vertices.size();
+    size_t from = 0;
+    size_t edgesToTest = count;
+    auto chain = facingChain(ray.getStart());
+    if (chain.has_value()) {
+        auto [first, last] = *chain;
+        size_t length = (last + count - first) % count + 1;
+        const auto& dir = ray.getDirectionVector();
+        auto side = [this, &ray, &dir, first, count](size_t i) {
+            GeometryNS::PointF toVertex =
+                GeometryNS::toPointF(vertices[(first + i) % count] - ray.getStart());
+            double value = dir.x * toVertex.y - dir.y * toVertex.x;
+            return (value > 0) - (value < 0);
+        };
+        int firstSide = side(0);
+        if (firstSide != 0 && firstSide == side(length - 1)) {
+            return std::nullopt;
+        }
+        size_t straddle = firstWhere(1, length - 1, [&side, firstSide](size_t i) {
+            return side(i) != firstSide;
+        });
+        from = (first + straddle - 1 + count - 1) % count;
+        edgesToTest = 3;
+    }
+
+    std::optional<GeometryNS::Point> bestIntersection;
     double bestT = std::numeric_limits<double>::infinity();
-    auto pts = closedVertices();
-    for (size_t i = 1; i < pts.size(); ++i) {
-        const QPoint& ptA = pts[i - 1];
-        const QPoint& ptB = pts[i];
-        double ray_dx = std::cos(ray.getDirection());
-        double ray_dy = std::sin(ray.getDirection());
+    double ray_dx = ray.getDirectionVector().x;
+    double ray_dy = ray.getDirectionVector().y;
+    for (size_t k = 0; k < edgesToTest; ++k) {
+        size_t i = (from + k) % count;
+        const GeometryNS::Point& ptA = vertices[i];
+        const GeometryNS::Point& ptB = vertices[(i + 1) % count];
         auto optParams = computeIntersectionParams(ptA, ptB, ray.getStart(), ray_dx, ray_dy);
         if (!optParams.has_value()) {
             continue;
         }
-        double denominator = ray_dx * (ptB.y() - ptA.y()) - ray_dy * (ptB.x() - ptA.x());
-        double t = ((ptA.x() - ray.getStart().x()) * (ptB.y() - ptA.y()) -
-                    (ptA.y() - ray.getStart().y()) * (ptB.x() - ptA.x())) /
-                   denominator;
-        double u =
-            ((ptA.x() - ray.getStart().x()) * ray_dy - (ptA.y() - ray.getStart().y()) * ray_dx) /
-            denominator;
-        if (t >= 0 && u >= 0 && u <= 1) {
-            if (t < bestT) {
-                bestT = t;
-                QPoint intersectPt(
-                    static_cast<int>(ray.getStart().x() + ray_dx * t),
-                    static_cast<int>(ray.getStart().y() + ray_dy * t));
-                bestIntersection = intersectPt;
-            }
+        auto [t, u] = *optParams;
+        if (t >= 0 && u >= 0 && u <= 1 && t < bestT) {
+            bestT = t;
+            bestIntersection = GeometryNS::Point{
+                static_cast<int>(ray.getStart().x + ray_dx * t),
+                static_cast<int>(ray.getStart().y + ray_dy * t)};
         }
     }
     return bestIntersection;
@@ -2,28 +2,51 @@
 #define POLYGON_H
 
 #include "functions.h"
+#include "geometry.h"
 #include "ray.h"
 
-#include <QPoint>
 #include <optional>
+#include <utility>
 #include <vector>
 
 namespace PolygonShapeNS {
 
+enum class PointLocation { Outside, Boundary, Inside };
+
 class PolygonShape {
    public:
     PolygonShape();
-    explicit PolygonShape(const std::vector<QPoint>& points);
-    void addVertex(const QPoint& pt);
-    void updateLastVertex(const QPoint& pt);
+    explicit PolygonShape(const std::vector<GeometryNS::Point>& points);
+    void addVertex(const GeometryNS::Point& pt);
+    void updateLastVertex(const GeometryNS::Point& pt);
     void clear();
-    const std::vector<QPoint>& getVertices() const;
+    const std::vector<GeometryNS::Point>& getVertices() const;
     bool isValid() const;
-    std::vector<QPoint> closedVertices() const;
-    std::optional<QPoint> findRayIntersection(const RaySegmentNS::RaySegment& ray) const;
+    std::vector<GeometryNS::Point> closedVertices() const;
+    // Kept up to date by every edit; meaningless while there are no vertices.
+    const GeometryNS::Box& getBounds() const;
+    // +1 for a simple counter-clockwise polygon (y up), -1 for a simple clockwise one, 0 when
+    // it is degenerate, self-touching or too large to check.
+    int simpleOrientation() const;
+    PointLocation locatePoint(const GeometryNS::Point& pt) const;
+    // Checks in O(n) whether the polygon is strictly convex and keeps the answer; called when the
+    // polygon is completed, every later edit clears the flag again.
+    void updateConvexity();
+    bool isConvex() const;
+    // For a convex polygon seen from a point outside its bounding box: the first and last vertex
+    // of the chain facing pt, walking in vertex order (it may wrap past the last vertex). The
+    // ends are the tangent vertices, and no other vertex is on the silhouette seen from pt.
+    // Found by binary search; nullopt for other polygons and for small ones.
+    std::optional<std::pair<size_t, size_t>> facingChain(const GeometryNS::Point& pt) const;
+    std::optional<GeometryNS::Point> findRayIntersection(const RaySegmentNS::RaySegment& ray) const;
 
    private:
-    std::vector<QPoint> vertices;
+    void updateBounds();
+
+    std::vector<GeometryNS::Point> vertices;
+    GeometryNS::Box bounds{};
+    // The orientation sign of a strictly convex polygon, 0 if it is not or was not checked.
+    int convexity = 0;
 };
 
 }  // namespace PolygonShapeNS
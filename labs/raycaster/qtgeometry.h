@@ -0,0 +1,22 @@
+#ifndef QTGEOMETRY_H
+#define QTGEOMETRY_H
+
+#include "geometry.h"
+
+#include <QPoint>
+#include <QPointF>
+
+// The only place where core geometry meets Qt types.
+inline QPoint toQPoint(const GeometryNS::Point& pt) {
+    return QPoint(pt.x, pt.y);
+}
+
+inline QPointF toQPointF(const GeometryNS::PointF& pt) {
+    return QPointF(pt.x, pt.y);
+}
+
+inline GeometryNS::Point fromQPoint(const QPoint& pt) {
+    return {pt.x(), pt.y()};
+}
+
+#endif  // QTGEOMETRY_H
@@ -0,0 +1,41 @@
+#include "raster.h"
+
+namespace RasterNS {
+
+// Every edge crosses the rows whose center line lies in [top, bottom) of it, so a vertex on a
+// center line is counted once and the crossings of a row pair up.
+void collectRowCrossings(
+    const std::vector<GeometryNS::Point>& polygon, int cellSize, int rows, RowCrossings* out) {
+    auto& crossings = out->crossings;
+    auto& rowStarts = out->rowStarts;
+    crossings.clear();
+    rowStarts.assign(static_cast<size_t>(std::max(rows, 0)) + 1, 0);
+    if (polygon.size() < 3) {
+        return;
+    }
+    double cell = cellSize;
+    for (size_t i = 0; i < polygon.size(); ++i) {
+        const auto& ptA = polygon[i];
+        const auto& ptB = polygon[(i + 1) % polygon.size()];
+        if (ptA.y == ptB.y) {
+            continue;
+        }
+        int rowFrom = std::max(0, firstCellFrom(std::min(ptA.y, ptB.y) / cell));
+        int rowTo = std::min(rows, firstCellFrom(std::max(ptA.y, ptB.y) / cell));
+        double slope = static_cast<double>(ptB.x - ptA.x) / (ptB.y - ptA.y);
+        for (int row = rowFrom; row < rowTo; ++row) {
+            double y = (row + 0.5) * cell;
+            double x = (ptA.x + (y - ptA.y) * slope) / cell;
+            crossings.emplace_back(row, static_cast<float>(x));
+        }
+    }
+    std::ranges::sort(crossings);
+    for (const auto& crossing : crossings) {
+        ++rowStarts[static_cast<size_t>(crossing.first) + 1];
+    }
+    for (size_t row = 0; row + 1 < rowStarts.size(); ++row) {
+        rowStarts[row + 1] += rowStarts[row];
+    }
+}
+
+}  // namespace RasterNS
@@ -0,0 +1,49 @@
+#ifndef RASTER_H
+#define RASTER_H
+
+#include "geometry.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace RasterNS {
+
+// Where a polygon outline crosses the center lines of the rows of a grid of square cells, x in
+// cells, sorted by row and then by x. The crossings of a row pair up into the runs the polygon
+// covers (even-odd); those of row r are crossings[rowStarts[r]] .. crossings[rowStarts[r + 1]].
+struct RowCrossings {
+    std::vector<std::pair<int32_t, float>> crossings;
+    std::vector<uint32_t> rowStarts;
+};
+
+// Overwrites *out for rows [0, rows) of cellSize-pixel cells; a vertex on a center line counts
+// for one of its two edges only.
+void collectRowCrossings(
+    const std::vector<GeometryNS::Point>& polygon, int cellSize, int rows, RowCrossings* out);
+
+// First cell whose center is at or after coordinate (in cells).
+inline int firstCellFrom(double coordinate) {
+    return static_cast<int>(std::ceil(coordinate - 0.5));
+}
+
+// Calls run(from, to) for every covered run of the row, cells [from, to) clipped to [0, width)
+// and never empty.
+template <class Run>
+void forEachRun(const RowCrossings& outline, size_t row, int width, Run run) {
+    const auto& crossings = outline.crossings;
+    for (uint32_t c = outline.rowStarts[row]; c + 1 < outline.rowStarts[row + 1]; c += 2) {
+        int from = std::clamp(firstCellFrom(crossings[c].second), 0, width);
+        int to = std::clamp(firstCellFrom(crossings[c + 1].second), 0, width);
+        if (from < to) {
+            run(from, to);
+        }
+    }
+}
+
+}  // namespace RasterNS
+
+#endif  // RASTER_H
@@ -1,35 +1,96 @@
-#ifndef RAY_H
-#define RAY_H
+#include "ray.h"
 
 #include "functions.h"
 
-#include <QPoint>
 #include <cmath>
-#include <optional>
 
 namespace RaySegmentNS {
 
-class RaySegment {
-   public:
-    RaySegment(const QPoint& origin, const QPoint& endpoint, double angle);
-    RaySegment(const QPoint& origin, const QPoint& endpoint);
-    RaySegment(const QPoint& origin, double angle, double length);
-    const QPoint& getStart() const;
-    const QPoint& getEnd() const;
-    double getDirection() const;
-    void setStart(const QPoint& pt);
-    void setEnd(const QPoint& pt);
-    void setDirection(double angle);
-    RaySegment rotated(double delta_angle) const;
-    double getLength() const;
-    static bool areParallel(const RaySegment& a, const RaySegment& b);
-
-   private:
-    QPoint start;
-    QPoint end;
-    double direction;
-};
+namespace {
 
-}  // namespace RaySegmentNS
+GeometryNS::PointF unitVector(double angle) {
+    return {std::cos(angle), std::sin(angle)};
+}
+
+// The exact integer offset between the points, so that a hit on `to` itself comes out at t == 1
+// with no rounding. A zero-length ray points along +x, as atan2(0, 0) == 0 did.
+GeometryNS::PointF offsetVector(const GeometryNS::Point& from, const GeometryNS::Point& to) {
+    if (from == to) {
+        return {1.0, 0.0};
+    }
+    return GeometryNS::toPointF(to - from);
+}
+
+}  // namespace
+
+RaySegment::RaySegment(
+    const GeometryNS::Point& origin, const GeometryNS::Point& endpoint, double angle)
+    : start(origin), end(endpoint), direction(unitVector(angle)) {
+}
+
+RaySegment::RaySegment(const GeometryNS::Point& origin, const GeometryNS::Point& endpoint)
+    : start(origin), end(endpoint), direction(offsetVector(origin, endpoint)) {
+}
+
+RaySegment::RaySegment(const GeometryNS::Point& origin, double angle, double length)
+    : RaySegment(origin, unitVector(angle), length) {
+}
+
+RaySegment::RaySegment(
+    const GeometryNS::Point& origin, const GeometryNS::PointF& dir, double length)
+    : start(origin)
+    , end(GeometryNS::truncated(
+          GeometryNS::toPointF(origin) + dir * (length / std::sqrt(dir.x * dir.x + dir.y * dir.y))))
+    , direction(dir) {
+}
+
+const GeometryNS::Point& RaySegment::getStart() const {
+    return start;
+}
+
+const GeometryNS::Point& RaySegment::getEnd() const {
+    return end;
+}
+
+double RaySegment::getDirection() const {
+    return normalizeAngle(std::atan2(direction.y, direction.x));
+}
 
-#endif  // RAY_H
+const GeometryNS::PointF& RaySegment::getDirectionVector() const {
+    return direction;
+}
+
+void RaySegment::setStart(const GeometryNS::Point& pt) {
+    start = pt;
+}
+
+void RaySegment::setEnd(const GeometryNS::Point& pt) {
+    end = pt;
+}
+
+void RaySegment::setDirection(double angle) {
+    direction = unitVector(angle);
+}
+
+RaySegment RaySegment::rotated(double delta_angle) const {
+    return rotated(GeometryNS::Rotation{std::cos(delta_angle), std::sin(delta_angle)});
+}
+
+RaySegment RaySegment::rotated(const GeometryNS::Rotation& rotation) const {
+    return RaySegment(start, GeometryNS::rotate(direction, rotation), getLength());
+}
+
+double RaySegment::getLength() const {
+    double vx = end.x - start.x;
+    double vy = end.y - start.y;
+    return std::sqrt(vx * vx + vy * vy);
+}
+
+bool RaySegment::areParallel(const RaySegment& a, const RaySegment& b) {
+    GeometryNS::Point vecA = a.end - a.start;
+    GeometryNS::Point vecB = b.end - b.start;
+    double cross = vecA.x * vecB.y - vecA.y * vecB.x;
+    return std::abs(cross) < 1e-9;
+}
+
+}  // namespace RaySegmentNS
@@ -1,63 +1,38 @@
-#include "ray.h"
+#ifndef RAY_H
+#define RAY_H
 
-namespace RaySegmentNS {
-
-RaySegment::RaySegment(const QPoint& origin, const QPoint& endpoint, double angle)
-    : start(origin), end(endpoint), direction(normalizeAngle(angle)) {
-}
-
-RaySegment::RaySegment(const QPoint& origin, const QPoint& endpoint)
-    : start(origin)
-    , end(endpoint)
-    , direction(normalizeAngle(std::atan2(endpoint.y() - origin.y(), endpoint.x() - origin.x()))) {
-}
-
-RaySegment::RaySegment(const QPoint& origin, double angle, double length)
-    : start(origin), direction(normalizeAngle(angle)) {
-    end = QPoint(
-        static_cast<int>(origin.x() + std::cos(angle) * length),
-        static_cast<int>(origin.y() + std::sin(angle) * length));
-}
-
-const QPoint& RaySegment::getStart() const {
-    return start;
-}
-
-const QPoint& RaySegment::getEnd() const {
-    return end;
-}
-
-double RaySegment::getDirection() const {
-    return direction;
-}
+#include "geometry.h"
 
-void RaySegment::setStart(const QPoint& pt) {
-    start = pt;
-}
-
-void RaySegment::setEnd(const QPoint& pt) {
-    end = pt;
-}
-
-void RaySegment::setDirection(double angle) {
-    direction = normalizeAngle(angle);
-}
-
-RaySegment RaySegment::rotated(double delta_angle) const {
-    double newAngle = normalizeAngle(direction + delta_angle);
-    double len = getLength();
-    return RaySegment(start, newAngle, len);
-}
-
-double RaySegment::getLength() const {
-    return calcDistance(start, end);
-}
+namespace RaySegmentNS {
 
-bool RaySegment::areParallel(const RaySegment& a, const RaySegment& b) {
-    QPoint vecA = a.end - a.start;
-    QPoint vecB = b.end - b.start;
-    double cross = vecA.x() * vecB.y() - vecA.y() * vecB.x();
-    return std::abs(cross) < 1e-9;
-}
+// The direction is kept as a vector, not necessarily of unit length: a ray built towards a point
+// stores the exact offset to it. The angle is only derived on request, so building, rotating,
+// sorting and tracing rays needs no trigonometry.
+class RaySegment {
+   public:
+    RaySegment(const GeometryNS::Point& origin, const GeometryNS::Point& endpoint, double angle);
+    RaySegment(const GeometryNS::Point& origin, const GeometryNS::Point& endpoint);
+    RaySegment(const GeometryNS::Point& origin, double angle, double length);
+    const GeometryNS::Point& getStart() const;
+    const GeometryNS::Point& getEnd() const;
+    double getDirection() const;
+    const GeometryNS::PointF& getDirectionVector() const;
+    void setStart(const GeometryNS::Point& pt);
+    void setEnd(const GeometryNS::Point& pt);
+    void setDirection(double angle);
+    RaySegment rotated(double delta_angle) const;
+    RaySegment rotated(const GeometryNS::Rotation& rotation) const;
+    double getLength() const;
+    static bool areParallel(const RaySegment& a, const RaySegment& b);
+
+   private:
+    RaySegment(const GeometryNS::Point& origin, const GeometryNS::PointF& dir, double length);
+
+    GeometryNS::Point start;
+    GeometryNS::Point end;
+    GeometryNS::PointF direction;
+};
 
 }  // namespace RaySegmentNS
+
+#endif  // RAY_H
@@ -0,0 +1,233 @@
+#include "scenefile.h"
+
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SCENEFILE_HAS_MMAP 1
+#endif
+
+namespace SceneFileNS {
+
+namespace {
+
+static_assert(std::endian::native == std::endian::little, "scene files are little-endian");
+
+void setError(std::string* error, const std::string& message) {
+    if (error != nullptr) {
+        *error = message;
+    }
+}
+
+size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace
+
+std::optional<std::vector<Polygon>> readTextScene(const std::string& path, std::string* error) {
+    std::ifstream file(path);
+    if (!file) {
+        setError(error, "cannot open " + path);
+        return std::nullopt;
+    }
+    std::vector<Polygon> polygons;
+    std::string line;
+    for (size_t lineNumber = 1; std::getline(file, line); ++lineNumber) {
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') {
+            continue;
+        }
+        std::istringstream coords(line);
+        std::vector<int> values;
+        int value = 0;
+        while (coords >> value) {
+            values.push_back(value);
+        }
+        if (!coords.eof() || values.size() % 2 != 0 || values.size() < 6) {
+            setError(
+                error, path + ":" + std::to_string(lineNumber) +
+                           ": expected at least three \"x y\" pairs of integers");
+            return std::nullopt;
+        }
+        Polygon polygon;
+        for (size_t i = 0; i < values.size(); i += 2) {
+            polygon.push_back({values[i], values[i + 1]});
+        }
+        polygons.push_back(std::move(polygon));
+    }
+    return polygons;
+}
+
+bool isBinaryScene(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    char magic[sizeof(SCENE_MAGIC)] = {};
+    file.read(magic, sizeof(magic));
+    return file && std::memcmp(magic, SCENE_MAGIC, sizeof(magic)) == 0;
+}
+
+bool writeBinaryScene(
+    const std::string& path, const std::vector<Polygon>& polygons, std::string* error) {
+    std::vector<uint32_t> offsets;
+    offsets.reserve(polygons.size() + 1);
+    uint64_t vertexCount = 0;
+    for (const auto& polygon : polygons) {
+        offsets.push_back(static_cast<uint32_t>(vertexCount));
+        vertexCount += polygon.size();
+    }
+    if (vertexCount > UINT32_MAX) {
+        setError(error, "scene is too large for format version 1");
+        return false;
+    }
+    offsets.push_back(static_cast<uint32_t>(vertexCount));
+
+    SceneHeader header{};
+    std::memcpy(header.magic, SCENE_MAGIC, sizeof(header.magic));
+    header.version = SCENE_VERSION;
+    header.polygonCount = static_cast<uint32_t>(polygons.size());
+    header.vertexCount = static_cast<uint32_t>(vertexCount);
+    header.offsetsOffset = sizeof(SceneHeader);
+    header.verticesOffset = alignUp(
+        header.offsetsOffset + offsets.size() * sizeof(uint32_t), alignof(GeometryNS::Point));
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(
+        reinterpret_cast<const char*>(offsets.data()),
+        static_cast<std::streamsize>(offsets.size() * sizeof(uint32_t)));
+    size_t offsetsEnd = header.offsetsOffset + offsets.size() * sizeof(uint32_t);
+    size_t padding = header.verticesOffset - offsetsEnd;
+    file.write("\0\0\0\0\0\0\0\0", static_cast<std::streamsize>(padding));
+    for (const auto& polygon : polygons) {
+        file.write(
+            reinterpret_cast<const char*>(polygon.data()),
+            static_cast<std::streamsize>(polygon.size() * sizeof(GeometryNS::Point)));
+    }
+    if (!file) {
+        setError(error, "cannot write " + path);
+        return false;
+    }
+    return true;
+}
+
+MappedScene::~MappedScene() {
+    close();
+}
+
+bool MappedScene::open(const std::string& path, std::string* error) {
+    close();
+#ifdef SCENEFILE_HAS_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    struct stat info {};
+    if (fd < 0 || ::fstat(fd, &info) != 0) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        setError(error, "cannot open " + path);
+        return false;
+    }
+    length = static_cast<size_t>(info.st_size);
+    if (length > 0) {
+        void* mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+            data = static_cast<const std::byte*>(mapped);
+        }
+    }
+    ::close(fd);
+    if (data == nullptr) {
+        length = 0;
+    }
+#endif
+    if (data == nullptr) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file) {
+            setError(error, "cannot open " + path);
+            return false;
+        }
+        buffer.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(
+            reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+        data = buffer.data();
+        length = buffer.size();
+    }
+
+    SceneHeader header{};
+    if (length < sizeof(header)) {
+        close();
+        setError(error, path + ": not a scene file");
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, SCENE_MAGIC, sizeof(header.magic)) != 0) {
+        close();
+        setError(error, path + ": not a scene file");
+        return false;
+    }
+    if (header.version != SCENE_VERSION) {
+        close();
+        setError(error, path + ": unsupported scene version " + std::to_string(header.version));
+        return false;
+    }
+    // Sizes come from 32-bit counts and cannot overflow; offsets are checked against the
+    // length before anything is added to them, so a corrupt header cannot wrap around.
+    auto fits = [this](uint64_t offset, uint64_t size) {
+        return offset <= length && size <= length - offset;
+    };
+    bool aligned = header.offsetsOffset % alignof(uint32_t) == 0 &&
+                   header.verticesOffset % alignof(GeometryNS::Point) == 0;
+    if (!aligned ||
+        !fits(header.offsetsOffset, (uint64_t{header.polygonCount} + 1) * sizeof(uint32_t)) ||
+        !fits(header.verticesOffset, uint64_t{header.vertexCount} * sizeof(GeometryNS::Point))) {
+        close();
+        setError(error, path + ": truncated or corrupt scene file");
+        return false;
+    }
+    offsets = reinterpret_cast<const uint32_t*>(data + header.offsetsOffset);
+    vertices = reinterpret_cast<const GeometryNS::Point*>(data + header.verticesOffset);
+    polygons = header.polygonCount;
+    bool monotonic = offsets[0] == 0 && offsets[polygons] == header.vertexCount;
+    for (size_t i = 0; monotonic && i < polygons; ++i) {
+        monotonic = offsets[i] <= offsets[i + 1];
+    }
+    if (!monotonic) {
+        close();
+        setError(error, path + ": corrupt polygon offsets");
+        return false;
+    }
+    return true;
+}
+
+void MappedScene::close() {
+#ifdef SCENEFILE_HAS_MMAP
+    if (data != nullptr && buffer.empty()) {
+        ::munmap(const_cast<std::byte*>(data), length);
+    }
+#endif
+    buffer.clear();
+    data = nullptr;
+    length = 0;
+    offsets = nullptr;
+    vertices = nullptr;
+    polygons = 0;
+}
+
+size_t MappedScene::polygonCount() const {
+    return polygons;
+}
+
+size_t MappedScene::vertexCount() const {
+    return polygons == 0 ? 0 : offsets[polygons];
+}
+
+std::span<const GeometryNS::Point> MappedScene::polygon(size_t i) const {
+    return {vertices + offsets[i], vertices + offsets[i + 1]};
+}
+
+}  // namespace SceneFileNS
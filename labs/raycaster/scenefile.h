@@ -0,0 +1,72 @@
+#ifndef SCENEFILE_H
+#define SCENEFILE_H
+
+#include "geometry.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace SceneFileNS {
+
+using Polygon = std::vector<GeometryNS::Point>;
+
+// Text scenes: one polygon per line as "x1 y1 x2 y2 ...", blank lines and lines starting with
+// '#' are skipped. The scene border is implicit and never stored. On failure error, when
+// given, receives a message with the offending line.
+std::optional<std::vector<Polygon>> readTextScene(const std::string& path, std::string* error);
+
+// Binary scenes, laid out so that a mapped file is used as is:
+//   SceneHeader, uint32 offsets[polygonCount + 1] (first vertex of each polygon, the last entry
+//   is vertexCount), GeometryNS::Point vertices[vertexCount] at verticesOffset.
+// All values are little-endian; the version changes whenever the layout does.
+constexpr char SCENE_MAGIC[4] = {'R', 'C', 'S', 'N'};
+constexpr uint32_t SCENE_VERSION = 1;
+
+struct SceneHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t polygonCount;
+    uint32_t vertexCount;
+    uint64_t offsetsOffset;
+    uint64_t verticesOffset;
+};
+
+static_assert(sizeof(SceneHeader) == 32);
+static_assert(sizeof(GeometryNS::Point) == 2 * sizeof(int32_t));
+
+bool isBinaryScene(const std::string& path);
+bool writeBinaryScene(
+    const std::string& path, const std::vector<Polygon>& polygons, std::string* error);
+
+// Read-only view of a binary scene file. The header and every offset are validated on open;
+// after that polygons are spans straight into the mapping, nothing is copied or parsed.
+class MappedScene {
+   public:
+    MappedScene() = default;
+    ~MappedScene();
+    MappedScene(const MappedScene&) = delete;
+    MappedScene& operator=(const MappedScene&) = delete;
+
+    bool open(const std::string& path, std::string* error);
+    void close();
+    size_t polygonCount() const;
+    size_t vertexCount() const;
+    std::span<const GeometryNS::Point> polygon(size_t i) const;
+
+   private:
+    const std::byte* data = nullptr;
+    size_t length = 0;
+    // Fallback copy of the file where mmap is not available.
+    std::vector<std::byte> buffer;
+    const uint32_t* offsets = nullptr;
+    const GeometryNS::Point* vertices = nullptr;
+    size_t polygons = 0;
+};
+
+}  // namespace SceneFileNS
+
+#endif  // SCENEFILE_H
@@ -0,0 +1,127 @@
+#include "scenefile.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace {
+
+using SceneFileNS::MappedScene;
+using SceneFileNS::Polygon;
+using SceneFileNS::SceneHeader;
+
+std::string tempPath(const std::string& name) {
+    return ::testing::TempDir() + "scenefile_test_" + name;
+}
+
+void writeBytes(const std::string& path, const std::vector<char>& bytes) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+std::vector<char> readBytes(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+// A valid header followed by `tail` zero bytes.
+std::vector<char> headerBytes(const SceneHeader& header, size_t tail) {
+    std::vector<char> bytes(sizeof(header) + tail, 0);
+    std::memcpy(bytes.data(), &header, sizeof(header));
+    return bytes;
+}
+
+SceneHeader validHeader() {
+    SceneHeader header{};
+    std::memcpy(header.magic, SceneFileNS::SCENE_MAGIC, sizeof(header.magic));
+    header.version = SceneFileNS::SCENE_VERSION;
+    header.offsetsOffset = sizeof(SceneHeader);
+    header.verticesOffset = sizeof(SceneHeader) + sizeof(uint64_t);
+    return header;
+}
+
+TEST(SceneFileTest, RoundTrip) {
+    std::string path = tempPath("round_trip");
+    std::vector<Polygon> polygons = {
+        {{10, 10}, {50, 10}, {30, 40}}, {{100, 100}, {200, 100}, {200, 200}, {100, 200}}};
+    ASSERT_TRUE(SceneFileNS::writeBinaryScene(path, polygons, nullptr));
+    ASSERT_TRUE(SceneFileNS::isBinaryScene(path));
+    MappedScene scene;
+    std::string error;
+    ASSERT_TRUE(scene.open(path, &error)) << error;
+    ASSERT_EQ(scene.polygonCount(), polygons.size());
+    EXPECT_EQ(scene.vertexCount(), 7U);
+    for (size_t i = 0; i < polygons.size(); ++i) {
+        auto loaded = scene.polygon(i);
+        EXPECT_EQ(Polygon(loaded.begin(), loaded.end()), polygons[i]);
+    }
+}
+
+TEST(SceneFileTest, RejectsTruncatedFile) {
+    std::string path = tempPath("truncated");
+    ASSERT_TRUE(SceneFileNS::writeBinaryScene(path, {{{0, 0}, {8, 0}, {0, 8}}}, nullptr));
+    auto bytes = readBytes(path);
+    for (size_t keep : {size_t{0}, size_t{4}, sizeof(SceneHeader) - 1, bytes.size() - 1}) {
+        writeBytes(path, std::vector<char>(bytes.begin(), bytes.begin() + keep));
+        MappedScene scene;
+        std::string error;
+        EXPECT_FALSE(scene.open(path, &error)) << "kept " << keep << " bytes";
+        EXPECT_FALSE(error.empty());
+        EXPECT_EQ(scene.polygonCount(), 0U);
+    }
+}
+
+TEST(SceneFileTest, RejectsOffsetsThatWrapAround) {
+    std::string path = tempPath("wrap");
+    SceneHeader header = validHeader();
+    header.offsetsOffset = std::numeric_limits<uint64_t>::max() - 3;
+    writeBytes(path, headerBytes(header, 8));
+    MappedScene scene;
+    EXPECT_FALSE(scene.open(path, nullptr));
+
+    header = validHeader();
+    header.verticesOffset = std::numeric_limits<uint64_t>::max() - 7;
+    header.vertexCount = 1;
+    writeBytes(path, headerBytes(header, 8));
+    EXPECT_FALSE(scene.open(path, nullptr));
+}
+
+TEST(SceneFileTest, RejectsCorruptHeader) {
+    std::string path = tempPath("corrupt");
+    SceneHeader header = validHeader();
+    header.magic[0] = 'X';
+    writeBytes(path, headerBytes(header, 8));
+    MappedScene scene;
+    EXPECT_FALSE(scene.open(path, nullptr));
+
+    header = validHeader();
+    header.version = SceneFileNS::SCENE_VERSION + 1;
+    writeBytes(path, headerBytes(header, 8));
+    EXPECT_FALSE(scene.open(path, nullptr));
+
+    header = validHeader();
+    header.offsetsOffset = sizeof(SceneHeader) + 1;
+    writeBytes(path, headerBytes(header, 8));
+    EXPECT_FALSE(scene.open(path, nullptr));
+}
+
+TEST(SceneFileTest, RejectsOffsetsOutOfOrder) {
+    std::string path = tempPath("order");
+    ASSERT_TRUE(SceneFileNS::writeBinaryScene(
+        path, {{{0, 0}, {8, 0}, {0, 8}}, {{20, 20}, {28, 20}, {20, 28}}}, nullptr));
+    auto bytes = readBytes(path);
+    uint32_t middle = 7;
+    std::memcpy(bytes.data() + sizeof(SceneHeader) + sizeof(uint32_t), &middle, sizeof(middle));
+    writeBytes(path, bytes);
+    MappedScene scene;
+    std::string error;
+    EXPECT_FALSE(scene.open(path, &error));
+    EXPECT_NE(error.find("offsets"), std::string::npos);
+}
+
+}  // namespace
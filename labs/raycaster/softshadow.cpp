@@ -0,0 +1,189 @@
+#include "softshadow.h"
+
+#include "raster.h"
+#include "utils.h"
+#include "workerpool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numbers>
+#include <random>
+
+namespace SoftShadowNS {
+
+namespace {
+
+constexpr uint32_t JITTER_SEED = 0x5EED'0023U;
+// Each sample traces a whole visibility polygon, so one per chunk already pays for the hand-off.
+constexpr size_t SAMPLES_PER_CHUNK = 1;
+constexpr size_t ROWS_PER_CHUNK = 8;
+// Weight of the newest frame in the smoothed cost of a sample.
+constexpr double COST_SMOOTHING = 0.25;
+
+const double GOLDEN_ANGLE = std::numbers::pi * (3.0 - std::sqrt(5.0));
+
+}  // namespace
+
+SampleBudget::SampleBudget(double budgetMilliseconds, size_t minSamples, size_t maxSamples)
+    : budget(budgetMilliseconds)
+    , minCount(minSamples)
+    , maxCount(std::max(minSamples, maxSamples))
+    , sampleCost(0.0)
+    , current(minSamples) {
+}
+
+size_t SampleBudget::sampleCount() const {
+    return current;
+}
+
+void SampleBudget::record(size_t samples, double milliseconds) {
+    if (samples == 0) {
+        return;
+    }
+    double cost = milliseconds / static_cast<double>(samples);
+    sampleCost = sampleCost == 0.0 ? cost : sampleCost + COST_SMOOTHING * (cost - sampleCost);
+    double affordable = sampleCost > 0.0 ? budget / sampleCost : static_cast<double>(maxCount);
+    current = std::clamp(
+        static_cast<size_t>(std::min(affordable, static_cast<double>(maxCount))), minCount,
+        maxCount);
+}
+
+void SampleBudget::setBudget(double budgetMilliseconds) {
+    budget = budgetMilliseconds;
+}
+
+double SampleBudget::getBudget() const {
+    return budget;
+}
+
+SoftShadowRenderer::SoftShadowRenderer()
+    : sampleBudget(
+          GlobalConfig::SOFT_SHADOW_BUDGET_MS, GlobalConfig::SOFT_SHADOW_MIN_SAMPLES,
+          GlobalConfig::SOFT_SHADOW_MAX_SAMPLES)
+    , activeSamples(0)
+    , samplesPerLight(0) {
+}
+
+void SoftShadowRenderer::render(
+    const Snapshot& scene, const std::vector<AreaLight>& lights, IntensityBuffer* buffer) {
+    auto started = std::chrono::steady_clock::now();
+    int cellSize = GlobalConfig::SOFT_SHADOW_CELL_SIZE;
+    buffer->cellSize = cellSize;
+    buffer->width = (GlobalConfig::SCENE_WIDTH + cellSize - 1) / cellSize;
+    buffer->height = (GlobalConfig::SCENE_HEIGHT + cellSize - 1) / cellSize;
+    buffer->values.resize(static_cast<size_t>(buffer->width) * buffer->height);
+    if (lights.empty()) {
+        std::ranges::fill(buffer->values, 0.0F);
+        activeSamples = 0;
+        return;
+    }
+    syncScene(scene);
+    updateOffsets(std::max<size_t>(1, sampleBudget.sampleCount() / lights.size()));
+    activeSamples = lights.size() * samplesPerLight;
+    if (samples.size() < activeSamples) {
+        samples.resize(activeSamples);
+    }
+    float weight = 1.0F / static_cast<float>(samplesPerLight);
+    for (size_t l = 0; l < lights.size(); ++l) {
+        for (size_t i = 0; i < samplesPerLight; ++i) {
+            const auto& offset = unitOffsets[i];
+            Sample& sample = samples[l * samplesPerLight + i];
+            sample.pos = GeometryNS::Point{
+                lights[l].center.x + static_cast<int>(std::lround(offset.x * lights[l].radius)),
+                lights[l].center.y + static_cast<int>(std::lround(offset.y * lights[l].radius))};
+            sample.weight = weight;
+        }
+    }
+
+    auto& pool = WorkerPoolNS::WorkerPool::shared();
+    auto traceRange = [this, buffer](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            traceSample(&samples[i], *buffer);
+        }
+    };
+    pool.parallelFor(activeSamples, traceRange, SAMPLES_PER_CHUNK);
+    // Rows are independent, so each chunk owns its rows of the buffer outright.
+    auto rowRange = [this, buffer](size_t begin, size_t end) {
+        accumulateRows(begin, end, buffer);
+    };
+    pool.parallelFor(static_cast<size_t>(buffer->height), rowRange, ROWS_PER_CHUNK);
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - started;
+    sampleBudget.record(activeSamples, elapsed.count());
+}
+
+size_t SoftShadowRenderer::lastSampleCount() const {
+    return samplesPerLight;
+}
+
+SampleBudget& SoftShadowRenderer::budget() {
+    return sampleBudget;
+}
+
+// Stratified in radius (equal areas of the disc) and spread by the golden angle, each sample
+// jittered inside its stratum. The pattern depends on the count only.
+void SoftShadowRenderer::updateOffsets(size_t count) {
+    if (count == samplesPerLight) {
+        return;
+    }
+    samplesPerLight = count;
+    std::mt19937 rng(JITTER_SEED);
+    std::uniform_real_distribution<double> jitter(0.0, 1.0);
+    unitOffsets.clear();
+    for (size_t i = 0; i < count; ++i) {
+        double radius = std::sqrt((static_cast<double>(i) + jitter(rng)) / count);
+        double angle = GOLDEN_ANGLE * (static_cast<double>(i) + jitter(rng));
+        unitOffsets.push_back({radius * std::cos(angle), radius * std::sin(angle)});
+    }
+}
+
+void SoftShadowRenderer::syncScene(const Snapshot& scene) {
+    if (scene == source && serialScene.has_value()) {
+        return;
+    }
+    source = scene;
+    serialScene.emplace(*scene);
+    serialScene->setParallelEnabled(false);
+    serialScene->setFrameStats(nullptr);
+}
+
+void SoftShadowRenderer::traceSample(Sample* sample, const IntensityBuffer& buffer) const {
+    // The first polygon is the scene border, which holds every light inside the scene.
+    const auto& polygons = serialScene->getPolygons();
+    bool blocked =
+        std::any_of(polygons.begin() + 1, polygons.end(), [sample](const auto& polygon) {
+            return polygon.locatePoint(sample->pos) == PolygonShapeNS::PointLocation::Inside;
+        });
+    if (blocked) {
+        sample->area.clear();
+    } else {
+        serialScene->computeLightArea(sample->pos, &sample->scratch, &sample->area);
+    }
+    RasterNS::collectRowCrossings(sample->area, buffer.cellSize, buffer.height, &sample->outline);
+}
+
+// Each covered run adds its weight at its first cell and takes it back after its last one; a
+// prefix sum over the row then gives the intensity of every cell.
+void SoftShadowRenderer::accumulateRows(size_t firstRow, size_t lastRow, IntensityBuffer* buffer) {
+    thread_local std::vector<float> deltas;
+    auto width = static_cast<size_t>(buffer->width);
+    for (size_t row = firstRow; row < lastRow; ++row) {
+        deltas.assign(width + 1, 0.0F);
+        for (size_t s = 0; s < activeSamples; ++s) {
+            const Sample& sample = samples[s];
+            RasterNS::forEachRun(sample.outline, row, buffer->width, [&](int from, int to) {
+                deltas[from] += sample.weight;
+                deltas[to] -= sample.weight;
+            });
+        }
+        float* values = buffer->values.data() + row * width;
+        float sum = 0.0F;
+        for (size_t x = 0; x < width; ++x) {
+            sum += deltas[x];
+            values[x] = sum;
+        }
+    }
+}
+
+}  // namespace SoftShadowNS
@@ -0,0 +1,99 @@
+#ifndef SOFTSHADOW_H
+#define SOFTSHADOW_H
+
+#include "controller.h"
+#include "geometry.h"
+#include "raster.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace SoftShadowNS {
+
+// A round light; it is rendered as point lights jittered over its disc.
+struct AreaLight {
+    GeometryNS::Point center;
+    int radius;
+
+    bool operator==(const AreaLight& other) const = default;
+};
+
+// Lit fraction per cell of cellSize x cellSize scene pixels, row by row. A cell every sample of
+// a light sees gets 1 from that light; the contributions of several lights add up.
+struct IntensityBuffer {
+    int width = 0;
+    int height = 0;
+    int cellSize = 1;
+    std::vector<float> values;
+};
+
+// Picks how many samples the next frame can afford: the cost of one sample is averaged over the
+// recent frames and the count is whatever fits into the budget, within [minSamples, maxSamples].
+class SampleBudget {
+   public:
+    SampleBudget(double budgetMilliseconds, size_t minSamples, size_t maxSamples);
+
+    size_t sampleCount() const;
+    void record(size_t samples, double milliseconds);
+    void setBudget(double budgetMilliseconds);
+    double getBudget() const;
+
+   private:
+    double budget;
+    size_t minCount;
+    size_t maxCount;
+    // Smoothed time of one sample; zero until the first frame is recorded.
+    double sampleCost;
+    size_t current;
+};
+
+// Renders soft shadows of area lights into an intensity buffer. The visibility polygons of all
+// samples are computed in parallel on the shared worker pool, each sample with a scratch of its
+// own, then turned into spans and added up row by row, again in parallel. Sample positions only
+// depend on the sample count, so while the count holds a dragged light moves every sample by
+// the same step and each sample keeps its scratch warm.
+// Not thread-safe; one renderer per rendering thread.
+class SoftShadowRenderer {
+   public:
+    using Snapshot = std::shared_ptr<const RaycasterController>;
+
+    SoftShadowRenderer();
+
+    // Samples inside an occluder see nothing; they count towards the total all the same.
+    void render(
+        const Snapshot& scene, const std::vector<AreaLight>& lights, IntensityBuffer* buffer);
+    // Samples per light used by the last render.
+    size_t lastSampleCount() const;
+    SampleBudget& budget();
+
+   private:
+    struct Sample {
+        GeometryNS::Point pos;
+        float weight = 0.0F;
+        LightScratch scratch;
+        std::vector<GeometryNS::Point> area;
+        RasterNS::RowCrossings outline;
+    };
+
+    void updateOffsets(size_t samplesPerLight);
+    void syncScene(const Snapshot& scene);
+    void traceSample(Sample* sample, const IntensityBuffer& buffer) const;
+    void accumulateRows(size_t firstRow, size_t lastRow, IntensityBuffer* buffer);
+
+    SampleBudget sampleBudget;
+    // The snapshot the serial copy was made from. The copy traces its rays on the calling
+    // thread, since its samples already run on the pool.
+    Snapshot source;
+    std::optional<RaycasterController> serialScene;
+    std::vector<GeometryNS::PointF> unitOffsets;
+    std::vector<Sample> samples;
+    size_t activeSamples;
+    size_t samplesPerLight;
+};
+
+}  // namespace SoftShadowNS
+
+#endif  // SOFTSHADOW_H
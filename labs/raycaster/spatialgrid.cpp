@@ -0,0 +1,239 @@
+#include "spatialgrid.h"
+
+#include "utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace SpatialGridNS {
+
+SpatialGrid::SpatialGrid() : cellSize(GlobalConfig::GRID_CELL_SIZE), columns(0), rows(0) {
+    resetBounds({0, 0}, {GlobalConfig::SCENE_WIDTH, GlobalConfig::SCENE_HEIGHT});
+}
+
+void SpatialGrid::rebuild(const EdgeStoreNS::EdgeStore& edges, std::optional<size_t> skipped) {
+    GeometryNS::Point minPt{0, 0};
+    GeometryNS::Point maxPt{GlobalConfig::SCENE_WIDTH, GlobalConfig::SCENE_HEIGHT};
+    for (size_t i = 0; i < edges.size(); ++i) {
+        if (skipped == edges.polygonOf(i)) {
+            continue;
+        }
+        // Every vertex starts exactly one edge, so the start points cover the whole scene.
+        GeometryNS::PointF pt = edges.startPoint(i);
+        minPt = GeometryNS::Point{
+            std::min(minPt.x, static_cast<int>(std::floor(pt.x))),
+            std::min(minPt.y, static_cast<int>(std::floor(pt.y)))};
+        maxPt = GeometryNS::Point{
+            std::max(maxPt.x, static_cast<int>(std::ceil(pt.x))),
+            std::max(maxPt.y, static_cast<int>(std::ceil(pt.y)))};
+    }
+    resetBounds(minPt, maxPt);
+    for (size_t id = 0; id < edges.polygonCount(); ++id) {
+        if (skipped != id) {
+            insertPolygon(id, edges);
+        }
+    }
+}
+
+bool SpatialGrid::insertPolygon(size_t polygonId, const EdgeStoreNS::EdgeStore& edges) {
+    size_t from = edges.firstEdge(polygonId);
+    size_t to = edges.lastEdge(polygonId);
+    for (size_t i = from; i < to; ++i) {
+        if (!contains(edges.startPoint(i))) {
+            return false;
+        }
+    }
+    if (polygonCells.size() <= polygonId) {
+        polygonCells.resize(polygonId + 1);
+    }
+    auto& touched = polygonCells[polygonId];
+    for (size_t i = from; i < to; ++i) {
+        GeometryNS::PointF ptA = edges.startPoint(i);
+        GeometryNS::PointF ptB = edges.endPoint(i);
+        int colFrom = columnOf(std::min(ptA.x, ptB.x));
+        int colTo = columnOf(std::max(ptA.x, ptB.x));
+        int rowFrom = rowOf(std::min(ptA.y, ptB.y));
+        int rowTo = rowOf(std::max(ptA.y, ptB.y));
+        for (int row = rowFrom; row <= rowTo; ++row) {
+            for (int col = colFrom; col <= colTo; ++col) {
+                size_t idx = cellIndex(col, row);
+                cells[idx].push_back(static_cast<uint32_t>(i));
+                touched.push_back(idx);
+            }
+        }
+    }
+    std::ranges::sort(touched);
+    auto dup = std::ranges::unique(touched);
+    touched.erase(dup.begin(), dup.end());
+    return true;
+}
+
+// Must run before the polygon's edges are patched in the store.
+void SpatialGrid::removePolygon(size_t polygonId, const EdgeStoreNS::EdgeStore& edges) {
+    if (polygonId >= polygonCells.size()) {
+        return;
+    }
+    for (size_t idx : polygonCells[polygonId]) {
+        std::erase_if(cells[idx], [polygonId, &edges](uint32_t edge) {
+            return edges.polygonOf(edge) == polygonId;
+        });
+    }
+    polygonCells[polygonId].clear();
+}
+
+void SpatialGrid::clear() {
+    for (auto& cell : cells) {
+        cell.clear();
+    }
+    polygonCells.clear();
+}
+
+void SpatialGrid::filterCells(const std::vector<uint8_t>& keep, CellView* view) const {
+    view->offsets.resize(cells.size() + 1);
+    view->edges.clear();
+    for (size_t idx = 0; idx < cells.size(); ++idx) {
+        view->offsets[idx] = static_cast<uint32_t>(view->edges.size());
+        for (uint32_t edge : cells[idx]) {
+            if (keep[edge] != 0) {
+                view->edges.push_back(edge);
+            }
+        }
+    }
+    view->offsets[cells.size()] = static_cast<uint32_t>(view->edges.size());
+}
+
+void SpatialGrid::collectEdges(const GeometryNS::Box& box, std::vector<uint32_t>* edges) const {
+    edges->clear();
+    int colFrom = columnOf(box.min.x);
+    int colTo = columnOf(box.max.x);
+    int rowFrom = rowOf(box.min.y);
+    int rowTo = rowOf(box.max.y);
+    for (int row = rowFrom; row <= rowTo; ++row) {
+        for (int col = colFrom; col <= colTo; ++col) {
+            const auto& cell = cells[cellIndex(col, row)];
+            edges->insert(edges->end(), cell.begin(), cell.end());
+        }
+    }
+    std::ranges::sort(*edges);
+    auto dup = std::ranges::unique(*edges);
+    edges->erase(dup.begin(), dup.end());
+}
+
+IntersectKernelNS::EdgeHit SpatialGrid::findNearestHit(
+    const IntersectKernelNS::RayParams& ray, const EdgeStoreNS::EdgeStore& edges,
+    const CellView* view, size_t* edgeTests, double maxT) const {
+    constexpr double inf = std::numeric_limits<double>::infinity();
+    double ox = ray.ox;
+    double oy = ray.oy;
+    double rdx = ray.dx;
+    double rdy = ray.dy;
+
+    // Clip the ray against the grid box so that lights outside the scene still work.
+    double tEnter = 0.0;
+    double tLeave = inf;
+    auto clipAxis = [&](double from, double dir, double lo, double hi) {
+        if (std::abs(dir) < GlobalConfig::EPSILON) {
+            return from >= lo && from <= hi;
+        }
+        double t1 = (lo - from) / dir;
+        double t2 = (hi - from) / dir;
+        tEnter = std::max(tEnter, std::min(t1, t2));
+        tLeave = std::min(tLeave, std::max(t1, t2));
+        return tEnter <= tLeave;
+    };
+    if (!clipAxis(ox, rdx, minCorner.x, maxCorner.x) ||
+        !clipAxis(oy, rdy, minCorner.y, maxCorner.y)) {
+        return {};
+    }
+
+    int col = columnOf(ox + rdx * tEnter);
+    int row = rowOf(oy + rdy * tEnter);
+    int stepX = rdx > 0 ? 1 : -1;
+    int stepY = rdy > 0 ? 1 : -1;
+    double tMaxX = inf;
+    double tDeltaX = inf;
+    if (std::abs(rdx) >= GlobalConfig::EPSILON) {
+        double boundary = minCorner.x + (col + (stepX > 0 ? 1 : 0)) * cellSize;
+        tMaxX = (boundary - ox) / rdx;
+        tDeltaX = cellSize / std::abs(rdx);
+    }
+    double tMaxY = inf;
+    double tDeltaY = inf;
+    if (std::abs(rdy) >= GlobalConfig::EPSILON) {
+        double boundary = minCorner.y + (row + (stepY > 0 ? 1 : 0)) * cellSize;
+        tMaxY = (boundary - oy) / rdy;
+        tDeltaY = cellSize / std::abs(rdy);
+    }
+
+    IntersectKernelNS::EdgeHit best;
+    auto scanCell = [&](int cellCol, int cellRow) {
+        size_t idx = cellIndex(cellCol, cellRow);
+        const uint32_t* cellEdges = cells[idx].data();
+        size_t count = cells[idx].size();
+        if (view != nullptr) {
+            cellEdges = view->edges.data() + view->offsets[idx];
+            count = view->offsets[idx + 1] - view->offsets[idx];
+        }
+        if (count == 0) {
+            return;
+        }
+        auto hit = edges.nearestHit(ray, cellEdges, count);
+        if (hit.t < best.t) {
+            best = hit;
+        }
+        if (edgeTests != nullptr) {
+            *edgeTests += count;
+        }
+    };
+    while (col >= 0 && col < columns && row >= 0 && row < rows) {
+        scanCell(col, row);
+        // Hits in later cells are farther than anything inside the current one.
+        if (best.t <= std::min(tMaxX, tMaxY) || std::min(tMaxX, tMaxY) > maxT) {
+            break;
+        }
+        if (tMaxX < tMaxY) {
+            col += stepX;
+            tMaxX += tDeltaX;
+        } else {
+            // Through a corner the walk steps diagonally; an edge ending exactly on that corner
+            // may be filed only in the side cell it skips.
+            if (tMaxX == tMaxY && col + stepX >= 0 && col + stepX < columns) {
+                scanCell(col + stepX, row);
+            }
+            row += stepY;
+            tMaxY += tDeltaY;
+        }
+    }
+    return best;
+}
+
+size_t SpatialGrid::cellIndex(int col, int row) const {
+    return static_cast<size_t>(row) * static_cast<size_t>(columns) + static_cast<size_t>(col);
+}
+
+int SpatialGrid::columnOf(double x) const {
+    int col = static_cast<int>(std::floor((x - minCorner.x) / cellSize));
+    return std::clamp(col, 0, columns - 1);
+}
+
+int SpatialGrid::rowOf(double y) const {
+    int row = static_cast<int>(std::floor((y - minCorner.y) / cellSize));
+    return std::clamp(row, 0, rows - 1);
+}
+
+bool SpatialGrid::contains(const GeometryNS::PointF& pt) const {
+    return pt.x >= minCorner.x && pt.x <= maxCorner.x && pt.y >= minCorner.y &&
+           pt.y <= maxCorner.y;
+}
+
+void SpatialGrid::resetBounds(const GeometryNS::Point& minPt, const GeometryNS::Point& maxPt) {
+    minCorner = minPt;
+    maxCorner = maxPt;
+    columns = (maxPt.x - minPt.x) / cellSize + 1;
+    rows = (maxPt.y - minPt.y) / cellSize + 1;
+    cells.assign(static_cast<size_t>(columns) * static_cast<size_t>(rows), {});
+    polygonCells.clear();
+}
+
+}  // namespace SpatialGridNS
@@ -0,0 +1,62 @@
+#ifndef SPATIALGRID_H
+#define SPATIALGRID_H
+
+#include "edgestore.h"
+#include "geometry.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace SpatialGridNS {
+
+// The cell lists of one frame with some edges left out, flattened: the edges of cell i are
+// edges[offsets[i]] .. edges[offsets[i + 1]].
+struct CellView {
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> edges;
+};
+
+// Uniform grid over polygon edges. Every edge is registered in each cell its bounding box
+// overlaps, and a ray query walks only the cells the ray crosses (Amanatides-Woo traversal).
+// Cells hold indices into the scene EdgeStore.
+class SpatialGrid {
+   public:
+    SpatialGrid();
+    void rebuild(const EdgeStoreNS::EdgeStore& edges, std::optional<size_t> skipped = std::nullopt);
+    bool insertPolygon(size_t polygonId, const EdgeStoreNS::EdgeStore& edges);
+    void removePolygon(size_t polygonId, const EdgeStoreNS::EdgeStore& edges);
+    void clear();
+    // Copies the cell lists into *view, keeping only the edges with a non-zero entry in keep.
+    void filterCells(const std::vector<uint8_t>& keep, CellView* view) const;
+    // Every edge registered in a cell that overlaps box, each once, in ascending order.
+    void collectEdges(const GeometryNS::Box& box, std::vector<uint32_t>* edges) const;
+    // Walks view instead of the full cell lists when one is given. edgeTests, when given, is
+    // increased by the number of edges the ray was tested against. The walk stops at cells
+    // that start beyond maxT; a hit past maxT found in an earlier cell is still returned.
+    IntersectKernelNS::EdgeHit findNearestHit(
+        const IntersectKernelNS::RayParams& ray, const EdgeStoreNS::EdgeStore& edges,
+        const CellView* view = nullptr, size_t* edgeTests = nullptr,
+        double maxT = std::numeric_limits<double>::infinity()) const;
+
+   private:
+    size_t cellIndex(int col, int row) const;
+    int columnOf(double x) const;
+    int rowOf(double y) const;
+    bool contains(const GeometryNS::PointF& pt) const;
+    void resetBounds(const GeometryNS::Point& minPt, const GeometryNS::Point& maxPt);
+
+    GeometryNS::Point minCorner;
+    GeometryNS::Point maxCorner;
+    int cellSize;
+    int columns;
+    int rows;
+    std::vector<std::vector<uint32_t>> cells;
+    std::vector<std::vector<size_t>> polygonCells;
+};
+
+}  // namespace SpatialGridNS
+
+#endif  // SPATIALGRID_H
@@ -0,0 +1,277 @@
+#include "sweepline.h"
+
+#include "functions.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory_resource>
+#include <numeric>
+#include <optional>
+#include <set>
+#include <utility>
+
+namespace SweepLineNS {
+
+namespace {
+
+constexpr double NUDGE_ANGLE = 1e-6;
+// A tree node plus one handle per segment, with room for allocator alignment.
+constexpr size_t ARENA_BYTES_PER_SEGMENT = 64;
+constexpr size_t ARENA_BASE_BYTES = 4096;
+
+double cross(const GeometryNS::PointF& a, const GeometryNS::PointF& b) {
+    return a.x * b.y - a.y * b.x;
+}
+
+// Distance along dir (in units of |dir|) from the light to the supporting line of the segment.
+double hitParam(
+    const Segment& seg, const GeometryNS::PointF& light, const GeometryNS::PointF& dir) {
+    GeometryNS::PointF edge = seg.b - seg.a;
+    double denominator = cross(dir, edge);
+    if (std::abs(denominator) < GlobalConfig::EPSILON) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return cross(seg.a - light, edge) / denominator;
+}
+
+struct SweepState {
+    const std::vector<Segment>* segments;
+    GeometryNS::PointF light;
+    GeometryNS::PointF dir;
+};
+
+// Orders the active segments front to back along the current sweep direction. Segments that
+// meet on the sweep ray are ordered by where they go just after it, and segments that agree
+// on both by index, so the order is strict and weak: every comparison is exact, none goes
+// through a tolerance. The sweep direction is always an endpoint, and every segment starting
+// there hits the ray at exactly 1, so those ties are real ones.
+class CloserToLight {
+   public:
+    explicit CloserToLight(const SweepState* sweepState) : state(sweepState) {
+    }
+
+    bool operator()(size_t lhs, size_t rhs) const {
+        const auto& segs = *state->segments;
+        double tl = hitParam(segs[lhs], state->light, state->dir);
+        double tr = hitParam(segs[rhs], state->light, state->dir);
+        if (tl != tr) {
+            return tl < tr;
+        }
+        GeometryNS::PointF nudged{
+            state->dir.x - NUDGE_ANGLE * state->dir.y,
+            state->dir.y + NUDGE_ANGLE * state->dir.x};
+        double nl = hitParam(segs[lhs], state->light, nudged);
+        double nr = hitParam(segs[rhs], state->light, nudged);
+        if (nl != nr) {
+            return nl < nr;
+        }
+        return lhs < rhs;
+    }
+
+   private:
+    const SweepState* state;
+};
+
+// Fills scratch->raw with the non-degenerate edges and scratch->cuts with two (segment,
+// parameter) entries per proper crossing, the two entries of a crossing next to each other.
+void findCrossings(const EdgeStoreNS::EdgeStore& edges, SweepScratch* scratch) {
+    auto& raw = scratch->raw;
+    raw.clear();
+    for (size_t i = 0; i < edges.size(); ++i) {
+        GeometryNS::PointF ptA = edges.startPoint(i);
+        GeometryNS::PointF ptB = edges.endPoint(i);
+        if (ptA != ptB) {
+            raw.push_back({ptA, ptB});
+        }
+    }
+
+    // Sort-and-sweep along x as the broad phase for crossing tests.
+    auto& order = scratch->order;
+    order.resize(raw.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::ranges::sort(order, [&raw](size_t lhs, size_t rhs) {
+        return std::min(raw[lhs].a.x, raw[lhs].b.x) < std::min(raw[rhs].a.x, raw[rhs].b.x);
+    });
+    auto& cuts = scratch->cuts;
+    cuts.clear();
+    for (size_t k = 0; k < order.size(); ++k) {
+        const Segment& first = raw[order[k]];
+        double maxX = std::max(first.a.x, first.b.x);
+        for (size_t m = k + 1; m < order.size(); ++m) {
+            const Segment& second = raw[order[m]];
+            if (std::min(second.a.x, second.b.x) > maxX) {
+                break;
+            }
+            if (std::max(first.a.y, first.b.y) < std::min(second.a.y, second.b.y) ||
+                std::max(second.a.y, second.b.y) < std::min(first.a.y, first.b.y)) {
+                continue;
+            }
+            GeometryNS::PointF r = first.b - first.a;
+            GeometryNS::PointF s = second.b - second.a;
+            double denominator = cross(r, s);
+            if (std::abs(denominator) < GlobalConfig::EPSILON) {
+                continue;
+            }
+            double t = cross(second.a - first.a, s) / denominator;
+            double u = cross(second.a - first.a, r) / denominator;
+            constexpr double lo = GlobalConfig::EPSILON;
+            constexpr double hi = 1.0 - GlobalConfig::EPSILON;
+            if (t > lo && t < hi && u > lo && u < hi) {
+                cuts.emplace_back(order[k], t);
+                cuts.emplace_back(order[m], u);
+            }
+        }
+    }
+}
+
+}  // namespace
+
+std::vector<Segment> collectSegments(const EdgeStoreNS::EdgeStore& edges) {
+    SweepScratch scratch;
+    collectSegments(edges, &scratch);
+    return std::move(scratch.segments);
+}
+
+void collectSegments(const EdgeStoreNS::EdgeStore& edges, SweepScratch* scratch) {
+    findCrossings(edges, scratch);
+    scratch->sceneGeneration = 0;
+    const auto& raw = scratch->raw;
+    // Sorted into per-segment runs of cut parameters.
+    auto& cuts = scratch->cuts;
+    std::ranges::sort(cuts);
+
+    auto& segments = scratch->segments;
+    segments.clear();
+    auto cut = cuts.begin();
+    for (size_t i = 0; i < raw.size(); ++i) {
+        GeometryNS::PointF prev = raw[i].a;
+        for (; cut != cuts.end() && cut->first == i; ++cut) {
+            GeometryNS::PointF pt = raw[i].a + (raw[i].b - raw[i].a) * cut->second;
+            segments.push_back({prev, pt});
+            prev = pt;
+        }
+        segments.push_back({prev, raw[i].b});
+    }
+}
+
+std::vector<GeometryNS::Point> computeVisibility(
+    const GeometryNS::Point& lightPos, const EdgeStoreNS::EdgeStore& edges) {
+    SweepScratch scratch;
+    std::vector<GeometryNS::Point> area;
+    computeVisibility(lightPos, edges, &scratch, &area);
+    return area;
+}
+
+void computeVisibility(
+    const GeometryNS::Point& lightPos, const EdgeStoreNS::EdgeStore& edges, SweepScratch* scratch,
+    std::vector<GeometryNS::Point>* area) {
+    computeVisibility(lightPos, edges, 0, scratch, area);
+}
+
+void computeVisibility(
+    const GeometryNS::Point& lightPos, const EdgeStoreNS::EdgeStore& edges,
+    uint64_t sceneGeneration, SweepScratch* scratch, std::vector<GeometryNS::Point>* area) {
+    if (sceneGeneration == 0 || scratch->sceneGeneration != sceneGeneration) {
+        collectSegments(edges, scratch);
+        scratch->sceneGeneration = sceneGeneration;
+    }
+    auto& segments = scratch->oriented;
+    segments.assign(scratch->segments.begin(), scratch->segments.end());
+    GeometryNS::PointF light = GeometryNS::toPointF(lightPos);
+
+    auto& events = scratch->events;
+    events.clear();
+    auto& spanningStart = scratch->spanningStart;
+    spanningStart.clear();
+    for (size_t i = 0; i < segments.size(); ++i) {
+        auto& seg = segments[i];
+        double orientation = cross(seg.a - light, seg.b - light);
+        if (std::abs(orientation) < GlobalConfig::EPSILON) {
+            continue;
+        }
+        if (orientation < 0) {
+            std::swap(seg.a, seg.b);
+        }
+        double angleA = normalizeAngle(std::atan2(seg.a.y - light.y, seg.a.x - light.x));
+        double angleB = normalizeAngle(std::atan2(seg.b.y - light.y, seg.b.x - light.x));
+        events.push_back({angleA, i, true});
+        events.push_back({angleB, i, false});
+        if (angleA > angleB) {
+            spanningStart.push_back(i);
+        }
+    }
+    std::ranges::sort(events, [](const SweepEvent& lhs, const SweepEvent& rhs) {
+        if (lhs.angle != rhs.angle) {
+            return lhs.angle < rhs.angle;
+        }
+        return !lhs.begins && rhs.begins;
+    });
+
+    // Every segment is inserted at most once, so the arena bounds the tree nodes and handles;
+    // the resource only falls back to the heap if that estimate is ever short.
+    size_t arenaBytes = ARENA_BASE_BYTES + segments.size() * ARENA_BYTES_PER_SEGMENT;
+    if (scratch->arena.size() < arenaBytes) {
+        scratch->arena.resize(arenaBytes);
+    }
+    std::pmr::monotonic_buffer_resource arena(scratch->arena.data(), scratch->arena.size());
+    SweepState state{&segments, light, GeometryNS::PointF{1.0, 0.0}};
+    using ActiveSet = std::pmr::multiset<size_t, CloserToLight>;
+    ActiveSet active{CloserToLight(&state), &arena};
+    std::pmr::vector<ActiveSet::iterator> handles(segments.size(), active.end(), &arena);
+    for (size_t i : spanningStart) {
+        handles[i] = active.insert(i);
+    }
+
+    auto pointOn = [&state, &segments](
+                       std::optional<size_t> seg, const GeometryNS::PointF& fallback) {
+        if (!seg.has_value()) {
+            return fallback;
+        }
+        double t = hitParam(segments[*seg], state.light, state.dir);
+        return std::isfinite(t) ? state.light + state.dir * t : fallback;
+    };
+    auto front = [&active]() -> std::optional<size_t> {
+        if (active.empty()) {
+            return std::nullopt;
+        }
+        return *active.begin();
+    };
+
+    area->clear();
+    auto emit = [area](const GeometryNS::PointF& pt) {
+        GeometryNS::Point rounded = GeometryNS::truncated(pt);
+        if (area->empty() || area->back() != rounded) {
+            area->push_back(rounded);
+        }
+    };
+    for (size_t e = 0; e < events.size();) {
+        const Segment& eventSeg = segments[events[e].segment];
+        GeometryNS::PointF endpoint = events[e].begins ? eventSeg.a : eventSeg.b;
+        state.dir = endpoint - light;
+        auto before = front();
+        double angle = events[e].angle;
+        for (; e < events.size() && events[e].angle == angle; ++e) {
+            size_t seg = events[e].segment;
+            if (!events[e].begins) {
+                if (handles[seg] != active.end()) {
+                    active.erase(handles[seg]);
+                    handles[seg] = active.end();
+                }
+            } else if (handles[seg] == active.end()) {
+                handles[seg] = active.insert(seg);
+            }
+        }
+        auto after = front();
+        if (before != after) {
+            emit(pointOn(before, endpoint));
+            emit(pointOn(after, endpoint));
+        }
+    }
+    if (area->size() > 1 && area->front() == area->back()) {
+        area->pop_back();
+    }
+}
+
+}  // namespace SweepLineNS
@@ -0,0 +1,59 @@
+#ifndef SWEEPLINE_H
+#define SWEEPLINE_H
+
+#include "edgestore.h"
+#include "geometry.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace SweepLineNS {
+
+using GeometryNS::Segment;
+
+struct SweepEvent {
+    double angle;
+    size_t segment;
+    bool begins;
+};
+
+// Working memory of one sweep, kept between calls so that repeated queries on the same scene
+// stop allocating once the buffers have grown to fit it. The active set and its handles are
+// carved out of `arena`. The split segments depend on the scene only; `sceneGeneration` tells
+// which scene they were split for, 0 meaning none.
+struct SweepScratch {
+    std::vector<Segment> raw;
+    std::vector<size_t> order;
+    std::vector<std::pair<size_t, double>> cuts;
+    std::vector<Segment> segments;
+    uint64_t sceneGeneration = 0;
+    // The split segments of one query, each turned counter-clockwise around the light.
+    std::vector<Segment> oriented;
+    std::vector<SweepEvent> events;
+    std::vector<size_t> spanningStart;
+    std::vector<std::byte> arena;
+};
+
+// Splits edges that properly cross each other so that the front-to-back order of any two
+// segments never changes during the sweep. Overlapping occluders are legal in the editor.
+std::vector<Segment> collectSegments(const EdgeStoreNS::EdgeStore& edges);
+void collectSegments(const EdgeStoreNS::EdgeStore& edges, SweepScratch* scratch);
+
+// Visibility polygon of a point light by the angular sweep: endpoints are sorted by angle once
+// and the segments spanning the current angle are kept ordered by distance from the light.
+std::vector<GeometryNS::Point> computeVisibility(
+    const GeometryNS::Point& lightPos, const EdgeStoreNS::EdgeStore& edges);
+void computeVisibility(
+    const GeometryNS::Point& lightPos, const EdgeStoreNS::EdgeStore& edges, SweepScratch* scratch,
+    std::vector<GeometryNS::Point>* area);
+// Splits the edges only when sceneGeneration is not the one the scratch last split them for,
+// so queries on an unchanged scene skip the crossing search; 0 splits them every time.
+void computeVisibility(
+    const GeometryNS::Point& lightPos, const EdgeStoreNS::EdgeStore& edges,
+    uint64_t sceneGeneration, SweepScratch* scratch, std::vector<GeometryNS::Point>* area);
+
+}  // namespace SweepLineNS
+
+#endif  // SWEEPLINE_H
@@ -1,8 +1,8 @@
 #ifndef UTILS_H
 #define UTILS_H
 
-#include <QColor>
 #include <cmath>
+#include <cstddef>
 #include <numbers>
 
 namespace GlobalConfig {
@@ -11,16 +11,22 @@ constexpr int LIGHT_DIAMETER = 6;
 constexpr double EPSILON = 1e-9;
 constexpr double ROTATION_DELTA = 1e-4;
 constexpr double ENDPOINT_TOLERANCE = 1e-3;
+constexpr int SCENE_WIDTH = 800;
+constexpr int SCENE_HEIGHT = 600;
+constexpr int GRID_CELL_SIZE = 32;
+constexpr size_t PARALLEL_RAY_THRESHOLD = 2048;
+constexpr int TARGET_FRAME_RATE = 60;
+constexpr int STATS_REFRESH_MS = 500;
+constexpr size_t LIGHT_CACHE_BUDGET_BYTES = 16 * 1024 * 1024;
+constexpr int AREA_LIGHT_RADIUS = 12;
+constexpr int SOFT_SHADOW_CELL_SIZE = 2;
+constexpr double SOFT_SHADOW_BUDGET_MS = 12.0;
+constexpr size_t SOFT_SHADOW_MIN_SAMPLES = 4;
+constexpr size_t SOFT_SHADOW_MAX_SAMPLES = 64;
+constexpr double LIGHT_ARC_STEP = 8.0;
+constexpr double LIGHT_SCHEDULE_BUDGET_MS = 8.0;
+constexpr int PINNED_LIGHT_RANGE = 320;
+constexpr float LIGHT_EXPOSURE = 200.0F / 55.0F;
 }  // namespace GlobalConfig
 
-namespace GlobalColors {
-const QColor BG_COLOR(9, 9, 46);
-const QColor FINISHED_FILL(Qt::black);
-const QColor ACTIVE_FILL(QColor(89, 20, 89, 100));
-const QColor STROKE_COLOR(Qt::white);
-const QColor LIGHT_COLOR(Qt::red);
-const QColor LIGHT_AREA_FILL(255, 255, 255, 200);
-const QColor SHADOW_FILL(255, 255, 255, 30);
-}  // namespace GlobalColors
-
 #endif  // UTILS_H
@@ -0,0 +1,103 @@
+#include "workerpool.h"
+
+#include <algorithm>
+
+namespace WorkerPoolNS {
+
+namespace {
+
+constexpr size_t CHUNKS_PER_THREAD = 4;
+
+}  // namespace
+
+WorkerPool::WorkerPool(size_t threadCount)
+    : job(nullptr)
+    , jobCount(0)
+    , chunkSize(0)
+    , nextIndex(0)
+    , activeWorkers(0)
+    , generation(0)
+    , stopping(false) {
+    workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        workers.emplace_back([this] { workerLoop(); });
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard lock(stateMutex);
+        stopping = true;
+    }
+    wakeWorkers.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+WorkerPool& WorkerPool::shared() {
+    static WorkerPool pool(std::max(1U, std::thread::hardware_concurrency()) - 1);
+    return pool;
+}
+
+size_t WorkerPool::concurrency() const {
+    return workers.size() + 1;
+}
+
+void WorkerPool::parallelFor(
+    size_t count, const std::function<void(size_t, size_t)>& body, size_t minChunk) {
+    if (count == 0) {
+        return;
+    }
+    std::lock_guard submit(submitMutex);
+    size_t chunk = std::max({minChunk, size_t{1}, count / (concurrency() * CHUNKS_PER_THREAD)});
+    if (workers.empty() || chunk >= count) {
+        body(0, count);
+        return;
+    }
+    {
+        std::lock_guard lock(stateMutex);
+        job = &body;
+        jobCount = count;
+        chunkSize = chunk;
+        nextIndex.store(0, std::memory_order_relaxed);
+        activeWorkers = workers.size();
+        ++generation;
+    }
+    wakeWorkers.notify_all();
+    runChunks();
+    std::unique_lock lock(stateMutex);
+    jobDone.wait(lock, [this] { return activeWorkers == 0; });
+    job = nullptr;
+}
+
+void WorkerPool::workerLoop() {
+    size_t seenGeneration = 0;
+    while (true) {
+        {
+            std::unique_lock lock(stateMutex);
+            wakeWorkers.wait(lock, [&] { return stopping || generation != seenGeneration; });
+            if (stopping) {
+                return;
+            }
+            seenGeneration = generation;
+        }
+        runChunks();
+        std::lock_guard lock(stateMutex);
+        if (--activeWorkers == 0) {
+            jobDone.notify_one();
+        }
+    }
+}
+
+void WorkerPool::runChunks() {
+    while (true) {
+        size_t begin = nextIndex.fetch_add(chunkSize, std::memory_order_relaxed);
+        if (begin >= jobCount) {
+            return;
+        }
+        (*job)(begin, std::min(begin + chunkSize, jobCount));
+    }
+}
+
+}  // namespace WorkerPoolNS
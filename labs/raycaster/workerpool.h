@@ -0,0 +1,54 @@
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace WorkerPoolNS {
+
+// Fixed set of threads that split index ranges between them. The calling thread works on the
+// range too, so a pool of N threads keeps N + 1 cores busy.
+class WorkerPool {
+   public:
+    static constexpr size_t DEFAULT_MIN_CHUNK = 64;
+
+    explicit WorkerPool(size_t threadCount);
+    ~WorkerPool();
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    static WorkerPool& shared();
+    size_t concurrency() const;
+    // Runs body(begin, end) over disjoint chunks covering [0, count) and returns when all of
+    // them are done. Calls from different threads are serialized; body must not call back in.
+    // Chunks hold at least minChunk indices; pass a small one when every index is a big job.
+    void parallelFor(
+        size_t count, const std::function<void(size_t, size_t)>& body,
+        size_t minChunk = DEFAULT_MIN_CHUNK);
+
+   private:
+    void workerLoop();
+    void runChunks();
+
+    std::vector<std::thread> workers;
+    std::mutex submitMutex;
+    std::mutex stateMutex;
+    std::condition_variable wakeWorkers;
+    std::condition_variable jobDone;
+    const std::function<void(size_t, size_t)>* job;
+    size_t jobCount;
+    size_t chunkSize;
+    std::atomic<size_t> nextIndex;
+    size_t activeWorkers;
+    size_t generation;
+    bool stopping;
+};
+
+}  // namespace WorkerPoolNS
+
+#endif  // WORKERPOOL_H